@@ -1,60 +1,105 @@
 #include <Agent.h>
-#include <Ship.h>
 
-unsigned int MarkovAgent::_seed = 0;
+#include <algorithm>
+#include <cstring>
 
-MarkovAgent::MarkovAgent()
-	: _randomDevice{ std::make_unique<std::random_device>(std::to_string((++MarkovAgent::_seed) * std::chrono::high_resolution_clock::now().time_since_epoch().count())) } {
+using GameJamAsteroids::Philox;
+using GameJamAsteroids::RandomStream;
+
+MarkovPolicy::MarkovPolicy(const uint64_t worldSeed)
+	: _random{ worldSeed } {
 }
 
-int MarkovAgent::update(float dt, Ship& ship) {
-	static SteeringState lastSteeringAction = SteeringState::Continue;
-	static SpeedState lastSpeedAction = SpeedState::Continue;
+void MarkovPolicy::resize(const size_t count) {
+	_lastSteeringAction.resize(count, SteeringState::Continue);
+	_lastSpeedAction.resize(count, SpeedState::Continue);
+}
 
-	auto pos = ship.position();
-	int posX = static_cast<int>(pos.x);
-	int posY = static_cast<int>(pos.y);
-	int length = posX + posY;
+void MarkovPolicy::prepare(const ShipObservations& observations) {
+	(void)observations;
+	++_tick;
+}
 
-	std::default_random_engine randomEngine((*_randomDevice)());
-	std::uniform_int_distribution<int> uniform_dist(0, 100);
+void MarkovPolicy::act(const ShipObservations& observations, ShipActions& actions, const size_t begin, const size_t end) {
+	// one block per ship and tick: whether and how to steer, whether and how to throttle
+	constexpr size_t Batch = 256;
+	uint32_t draws[4][Batch];
+	for (size_t first = begin; first < end; first += Batch) {
+		const auto count = std::min(Batch, end - first);
+		_random.generate(static_cast<uint32_t>(first), count, RandomStream::Policy, _tick, 0, draws[0], draws[1], draws[2], draws[3]);
 
-	SteeringState steeringAction = lastSteeringAction;
-	const bool doSteering = uniform_dist(randomEngine) < 2;
+		for (size_t k = 0; k < count; ++k) {
+			const auto i = first + k;
+			// in [0, 100]
+			auto percent = [&draws, k](const size_t lane) { return static_cast<int>(Philox::below(draws[lane][k], 101)); };
 
-	if (doSteering) {
-		auto action = uniform_dist(randomEngine);
-		if (action < 33) {
-			steeringAction = SteeringState::Left;
-		}
-		else if (action < 66) {
-			steeringAction = SteeringState::Right;
-		}
-		else {
-			steeringAction = SteeringState::Continue;
-		}
-	}
+			SteeringState steeringAction = _lastSteeringAction[i];
+			const bool doSteering = percent(0) < 2;
 
-	SpeedState speedAction = lastSpeedAction;
-	const bool doSpeed = uniform_dist(randomEngine) < 10;
+			if (doSteering) {
+				auto action = percent(1);
+				if (action < 33) {
+					steeringAction = SteeringState::Left;
+				}
+				else if (action < 66) {
+					steeringAction = SteeringState::Right;
+				}
+				else {
+					steeringAction = SteeringState::Continue;
+				}
+			}
 
-	if (doSpeed) {
-		auto action = uniform_dist(randomEngine);
-		if (action < 30) {
-			speedAction = SpeedState::Increase;
-		}
-		else if (action < 60) {
-			speedAction = SpeedState::Decrease;
-		}
-		else {
-			speedAction = SpeedState::Continue;
+			SpeedState speedAction = _lastSpeedAction[i];
+			const bool doSpeed = percent(2) < 10;
+
+			if (doSpeed) {
+				auto action = percent(3);
+				if (action < 30) {
+					speedAction = SpeedState::Increase;
+				}
+				else if (action < 60) {
+					speedAction = SpeedState::Decrease;
+				}
+				else {
+					speedAction = SpeedState::Continue;
+				}
+			}
+
+			actions.steering[i] = steeringAction;
+			actions.speed[i] = speedAction;
+
+			_lastSteeringAction[i] = steeringAction;
+			_lastSpeedAction[i] = speedAction;
 		}
 	}
+	(void)observations;
+}
 
-	ship.update(dt, steeringAction, speedAction);
-
-	lastSteeringAction = steeringAction;
-	lastSpeedAction = speedAction;
+bool MarkovPolicy::saveState(std::vector<uint8_t>& state) const {
+	// the tick, then the last steering and speed action of every ship
+	const auto offset = state.size();
+	state.resize(offset + sizeof(_tick) + 2 * _lastSteeringAction.size());
+	auto* out = state.data() + offset;
+	std::memcpy(out, &_tick, sizeof(_tick));
+	out += sizeof(_tick);
+	for (size_t i = 0; i < _lastSteeringAction.size(); ++i, out += 2) {
+		out[0] = static_cast<uint8_t>(_lastSteeringAction[i]);
+		out[1] = static_cast<uint8_t>(_lastSpeedAction[i]);
+	}
+	return true;
+}
 
-	return 0;
+bool MarkovPolicy::loadState(const uint8_t* state, const size_t size) {
+	if (size < sizeof(_tick) || (size - sizeof(_tick)) % 2 != 0) {
+		return false;
+	}
+	std::memcpy(&_tick, state, sizeof(_tick));
+	state += sizeof(_tick);
+	const auto count = (size - sizeof(_tick)) / 2;
+	resize(count);
+	for (size_t i = 0; i < count; ++i, state += 2) {
+		_lastSteeringAction[i] = static_cast<SteeringState>(std::min<uint8_t>(state[0], 2));
+		_lastSpeedAction[i] = static_cast<SpeedState>(std::min<uint8_t>(state[1], 2));
+	}
+	return true;
 }
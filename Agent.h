@@ -1,8 +1,9 @@
 #pragma once
 
+#include <Random.h>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <random>
-#include <memory>
 
 enum class SteeringState : int {
 	Continue,
@@ -16,18 +17,61 @@ enum class SpeedState : int {
 	Decrease
 };
 
-class Ship;
-struct IAgent {
-	virtual int update(float dt, Ship& ship) = 0;
+// What the policies see of every ship, in dense ECS order. The arrays point into the ship
+// columns and stay valid until ships are spawned or destroyed.
+struct ShipObservations {
+	size_t count{ 0 };
+	const float* x{ nullptr };
+	const float* y{ nullptr };
+	const float* heading{ nullptr };
+	const float* speed{ nullptr };
+	const float* vx{ nullptr };
+	const float* vy{ nullptr };
+	float width{ 0.0f };
+	float height{ 0.0f };
 };
 
-class MarkovAgent : public IAgent {
+// One action pair per ship, in the same order as the observations.
+struct ShipActions {
+	std::vector<SteeringState> steering;
+	std::vector<SpeedState> speed;
+
+	void resize(const size_t count) {
+		steering.resize(count, SteeringState::Continue);
+		speed.resize(count, SpeedState::Continue);
+	}
+};
+
+// Decides for a whole fleet at once instead of one virtual call per ship.
+struct IPolicy {
+	virtual ~IPolicy() = default;
+	// Called with the ship count before act() whenever it may have changed.
+	virtual void resize(const size_t count) = 0;
+	// Called once per tick on one thread, after resize() and before the act() calls.
+	virtual void prepare(const ShipObservations& observations) { (void)observations; }
+	// Writes the actions of ships [begin, end). Runs on several threads at once for disjoint ranges.
+	virtual void act(const ShipObservations& observations, ShipActions& actions, const size_t begin, const size_t end) = 0;
+	// Appends everything future act() calls depend on, for world checkpoints. Policies whose
+	// state lives elsewhere return false.
+	virtual bool saveState(std::vector<uint8_t>& state) const { (void)state; return false; }
+	virtual bool loadState(const uint8_t* state, const size_t size) { (void)state; (void)size; return false; }
+};
+
+// Every ship keeps steering and throttling as it did, now and then switching at random. Ship i
+// draws from Philox at (i, tick), so runs repeat at any thread count and the only state is the
+// tick and the last actions.
+class MarkovPolicy : public IPolicy {
 public:
-	MarkovAgent();
-	int update(float dt, Ship& ship) override;
+	explicit MarkovPolicy(const uint64_t worldSeed);
+	void resize(const size_t count) override;
+	void prepare(const ShipObservations& observations) override;
+	void act(const ShipObservations& observations, ShipActions& actions, const size_t begin, const size_t end) override;
+	bool saveState(std::vector<uint8_t>& state) const override;
+	bool loadState(const uint8_t* state, const size_t size) override;
 
 private:
-	static unsigned int _seed;
-	// Seed with a real random value, if available
-	std::unique_ptr<std::random_device> _randomDevice;
+	GameJamAsteroids::Philox _random;
+	uint32_t _tick{ 0 };
+	std::vector<SteeringState> _lastSteeringAction;
+	std::vector<SpeedState> _lastSpeedAction;
 };
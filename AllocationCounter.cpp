@@ -0,0 +1,113 @@
+#include <AllocationCounter.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+	std::atomic<uint64_t> gAllocations{ 0 };
+	std::atomic<uint64_t> gBytes{ 0 };
+
+	void* allocate(const size_t bytes, const size_t alignment) {
+		gAllocations.fetch_add(1, std::memory_order_relaxed);
+		gBytes.fetch_add(bytes, std::memory_order_relaxed);
+		const auto size = bytes == 0 ? 1 : bytes;
+		if (alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			return std::malloc(size);
+		}
+#ifdef _WIN32
+		return _aligned_malloc(size, alignment);
+#else
+		void* memory = nullptr;
+		return posix_memalign(&memory, alignment, size) == 0 ? memory : nullptr;
+#endif
+	}
+
+	void release(void* memory, const size_t alignment) {
+#ifdef _WIN32
+		if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+			_aligned_free(memory);
+			return;
+		}
+#endif
+		(void)alignment;
+		std::free(memory);
+	}
+
+	void* allocateOrThrow(const size_t bytes, const size_t alignment) {
+		if (auto* memory = allocate(bytes, alignment)) {
+			return memory;
+		}
+		throw std::bad_alloc();
+	}
+}
+
+namespace GameJamAsteroids {
+	AllocationCounts allocationCounts() {
+		return { gAllocations.load(std::memory_order_relaxed), gBytes.load(std::memory_order_relaxed) };
+	}
+}
+
+void* operator new(size_t bytes) {
+	return allocateOrThrow(bytes, 0);
+}
+
+void* operator new[](size_t bytes) {
+	return allocateOrThrow(bytes, 0);
+}
+
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+	return allocate(bytes, 0);
+}
+
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+	return allocate(bytes, 0);
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment) {
+	return allocateOrThrow(bytes, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment) {
+	return allocateOrThrow(bytes, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocate(bytes, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t bytes, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocate(bytes, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept {
+	release(memory, 0);
+}
+
+void operator delete[](void* memory) noexcept {
+	release(memory, 0);
+}
+
+void operator delete(void* memory, size_t) noexcept {
+	release(memory, 0);
+}
+
+void operator delete[](void* memory, size_t) noexcept {
+	release(memory, 0);
+}
+
+void operator delete(void* memory, std::align_val_t alignment) noexcept {
+	release(memory, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* memory, std::align_val_t alignment) noexcept {
+	release(memory, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept {
+	release(memory, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t alignment) noexcept {
+	release(memory, static_cast<size_t>(alignment));
+}
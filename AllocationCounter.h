@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace GameJamAsteroids {
+	struct AllocationCounts {
+		uint64_t allocations{ 0 };
+		uint64_t bytes{ 0 };
+	};
+
+	// Heap allocations made through operator new by every thread since the program started. The
+	// counting operator new lives in AllocationCounter.cpp and replaces the library one in every
+	// executable that links it.
+	AllocationCounts allocationCounts();
+}
@@ -0,0 +1,250 @@
+// Throughput benchmarks for the per-tick hot loops at several entity and thread counts.
+//
+// GameJamAsteroidsBenchmarks [--sizes 1000,10000,...] [--threads 1,2,...] [--min-time seconds] [--filter name]
+//                            [--save-baseline file] [--baseline file] [--tolerance fraction]
+//
+// Every case reports entities per second, the best of repeated runs lasting at least --min-time.
+// With --baseline each result is compared against the saved one and the exit code is 1 when any
+// case got slower by more than --tolerance.
+
+#include <Agent.h>
+#include <GameLoop.h>
+#include <JobSystem.h>
+#include <ParticleRenderer.h>
+#include <Renderer.h>
+#include <ShipSystem.h>
+#include <Simulation.h>
+#include <World.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace {
+	constexpr size_t Width = 2560;
+	constexpr size_t Height = 1440;
+
+	struct Result {
+		std::string name;
+		size_t entities;
+		size_t threads;
+		double entitiesPerSecond;
+	};
+
+	using Key = std::tuple<std::string, size_t, size_t>;
+
+	// Sets up a case for the given entity count and returns the step to time.
+	using Setup = std::function<std::function<void()>(size_t entities)>;
+
+	struct Benchmark {
+		const char* name;
+		Setup setup;
+	};
+
+	// Best entities/sec over at least three runs and at least minTime seconds, after one warm-up.
+	double measure(const size_t entities, const double minTime, const std::function<void()>& step) {
+		using Clock = std::chrono::steady_clock;
+		step();
+		double best = 0.0;
+		double total = 0.0;
+		for (int runs = 0; runs < 3 || total < minTime; ++runs) {
+			const auto start = Clock::now();
+			step();
+			const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+			total += seconds;
+			best = std::max(best, static_cast<double>(entities) / std::max(seconds, 1.0e-9));
+		}
+		return best;
+	}
+
+	std::shared_ptr<World> createFleet(const size_t count) {
+		auto world = std::make_shared<World>(GameJamAsteroids::createWorld(Width, Height, 0, 0));
+		std::vector<ecs::Vec2f> positions(count);
+		for (size_t i = 0; i < count; ++i) {
+			positions[i] = { static_cast<float>(i * 37 % Width), static_cast<float>(i * 91 % Height) };
+		}
+		GameJamAsteroids::spawnShips(world->ecs, positions, std::vector<ecs::Color>(count, sf::Color::White));
+		world->policy = std::make_unique<MarkovPolicy>(GameJamAsteroids::DefaultSeed);
+		return world;
+	}
+
+	std::vector<Benchmark> benchmarks() {
+		using namespace GameJamAsteroids;
+		return {
+			{ "simulation", [](const size_t entities) -> std::function<void()> {
+				auto world = std::make_shared<World>(createWorld(Width, Height, 0, entities));
+				buildForceField(world->field, world->wells, world->ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>(), Width, Height);
+				return [world]() {
+					auto& positions = world->ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
+					auto& velocities = world->ecs.data<ecs::EntityType::Square, ecs::ComponentType::Velocity>();
+					simulation(Width, Height, positions, velocities, world->field, GameLoop::FixedStep, world->integrator);
+				};
+			} },
+			{ "vertices", [](const size_t entities) -> std::function<void()> {
+				auto world = std::make_shared<World>(createWorld(Width, Height, 0, entities));
+				auto renderer = std::make_shared<ParticleRenderer>();
+				return [world, renderer]() {
+					const auto& ecs = world->ecs;
+					renderer->update(nullptr, nullptr, ecs.entities<ecs::EntityType::Square>(),
+						ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>(),
+						ecs.data<ecs::EntityType::Square, ecs::ComponentType::Size>(),
+						ecs.data<ecs::EntityType::Square, ecs::ComponentType::Color>(),
+						ecs.data<ecs::EntityType::Square, ecs::ComponentType::AngularVelocity>(),
+						1.0f, { static_cast<float>(Width), static_cast<float>(Height) }, 0.5f);
+				};
+			} },
+			// the ship integrator alone, under a fixed mix of actions
+			{ "shipUpdate", [](const size_t entities) -> std::function<void()> {
+				auto world = createFleet(entities);
+				world->shipActions.resize(entities);
+				for (size_t i = 0; i < entities; ++i) {
+					world->shipActions.steering[i] = static_cast<SteeringState>(i % 3);
+					world->shipActions.speed[i] = static_cast<SpeedState>(i % 3);
+				}
+				return [world]() {
+					integrateShips(Width, Height, world->ecs, world->shipActions, GameLoop::FixedStep, world->integrator);
+				};
+			} },
+			// policy and integrator, as in a tick
+			{ "markovPolicy", [](const size_t entities) -> std::function<void()> {
+				auto world = createFleet(entities);
+				return [world]() {
+					GameLoop::updateShips(*world, GameLoop::FixedStep);
+				};
+			} },
+		};
+	}
+
+	std::vector<size_t> parseList(const std::string& text) {
+		std::vector<size_t> values;
+		std::stringstream stream(text);
+		std::string item;
+		while (std::getline(stream, item, ',')) {
+			if (!item.empty()) {
+				values.push_back(std::stoul(item));
+			}
+		}
+		return values;
+	}
+
+	std::map<Key, double> loadBaseline(const std::string& path) {
+		std::map<Key, double> baseline;
+		std::ifstream file(path);
+		std::string name;
+		size_t entities, threads;
+		double entitiesPerSecond;
+		while (file >> name >> entities >> threads >> entitiesPerSecond) {
+			baseline[Key{ name, entities, threads }] = entitiesPerSecond;
+		}
+		return baseline;
+	}
+
+	bool saveBaseline(const std::string& path, const std::vector<Result>& results) {
+		std::ofstream file(path);
+		for (const auto& result : results) {
+			file << result.name << ' ' << result.entities << ' ' << result.threads << ' ' << result.entitiesPerSecond << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	std::vector<size_t> sizes{ 1000, 10000, 100000, 1000000 };
+	std::vector<size_t> threads{ 1, 2, 4, std::max<size_t>(1, std::thread::hardware_concurrency()) };
+	double minTime = 0.5;
+	double tolerance = 0.1;
+	std::string filter, baselinePath, savePath;
+
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (i + 1 >= argc) {
+			std::cerr << "missing value for " << arg << std::endl;
+			return 2;
+		}
+		const std::string value = argv[++i];
+		if (arg == "--sizes") {
+			sizes = parseList(value);
+		}
+		else if (arg == "--threads") {
+			threads = parseList(value);
+		}
+		else if (arg == "--min-time") {
+			minTime = std::stod(value);
+		}
+		else if (arg == "--filter") {
+			filter = value;
+		}
+		else if (arg == "--baseline") {
+			baselinePath = value;
+		}
+		else if (arg == "--save-baseline") {
+			savePath = value;
+		}
+		else if (arg == "--tolerance") {
+			tolerance = std::stod(value);
+		}
+		else {
+			std::cerr << "unknown option " << arg << std::endl;
+			return 2;
+		}
+	}
+
+	std::sort(threads.begin(), threads.end());
+	threads.erase(std::unique(threads.begin(), threads.end()), threads.end());
+
+	const auto baseline = baselinePath.empty() ? std::map<Key, double>{} : loadBaseline(baselinePath);
+	if (!baselinePath.empty() && baseline.empty()) {
+		std::cerr << "no results in baseline " << baselinePath << std::endl;
+		return 2;
+	}
+
+	std::vector<Result> results;
+	size_t regressions = 0;
+	std::printf("%-12s %10s %8s %16s %10s\n", "case", "entities", "threads", "entities/s", "vs base");
+	for (const auto& benchmark : benchmarks()) {
+		if (!filter.empty() && filter != benchmark.name) {
+			continue;
+		}
+		for (const auto entities : sizes) {
+			const auto step = benchmark.setup(entities);
+			for (const auto threadCount : threads) {
+				JobSystem::instance().setThreadCount(threadCount);
+				const Result result{ benchmark.name, entities, threadCount, measure(entities, minTime, step) };
+				results.push_back(result);
+
+				std::printf("%-12s %10zu %8zu %16.0f", result.name.c_str(), result.entities, result.threads, result.entitiesPerSecond);
+				const auto base = baseline.find(Key{ result.name, result.entities, result.threads });
+				if (base != baseline.end()) {
+					const double ratio = result.entitiesPerSecond / base->second;
+					const bool regressed = ratio < 1.0 - tolerance;
+					regressions += regressed ? 1 : 0;
+					std::printf(" %9.2fx%s", ratio, regressed ? "  REGRESSION" : "");
+				}
+				std::printf("\n");
+				std::fflush(stdout);
+			}
+		}
+	}
+
+	if (!savePath.empty()) {
+		if (!saveBaseline(savePath, results)) {
+			std::cerr << "could not write " << savePath << std::endl;
+			return 2;
+		}
+		std::cout << "baseline saved to " << savePath << std::endl;
+	}
+	if (regressions > 0) {
+		std::cout << regressions << " case(s) slower than the baseline by more than " << tolerance * 100.0 << "%" << std::endl;
+		return 1;
+	}
+	return 0;
+}
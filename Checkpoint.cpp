@@ -0,0 +1,359 @@
+#include <Checkpoint.h>
+#include <JobSystem.h>
+#include <MappedFile.h>
+#include <Renderer.h>
+#include <World.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace GameJamAsteroids {
+	namespace {
+		constexpr char Magic[4] = { 'G', 'J', 'A', 'W' };
+		// 2: MarkovPolicy state is its tick and last actions
+		constexpr uint32_t Version = 2;
+		// reads back as 0x04030201 on a host of the other byte order
+		constexpr uint32_t ByteOrderMark = 0x01020304;
+		constexpr size_t Alignment = 64;
+		// more than any world has, keeps a corrupt count from mapping the whole file as a table
+		constexpr uint32_t MaxSections = 4096;
+
+		struct Header {
+			char magic[4];
+			uint32_t version;
+			uint32_t byteOrder;
+			uint32_t sectionCount;
+			uint64_t tick;
+			uint64_t seed;
+			uint32_t width;
+			uint32_t height;
+			uint32_t integrator;
+			uint32_t reserved;
+			uint64_t shipContacts;
+			uint64_t particleContacts;
+		};
+		static_assert(sizeof(Header) == 64, "the header is one cache line on disk");
+
+		struct SectionEntry {
+			uint32_t kind;
+			uint32_t elementSize;
+			uint64_t count;
+			uint64_t offset;
+		};
+		static_assert(sizeof(SectionEntry) == 24, "section entries are packed on disk");
+
+		// A section's kind is entity type << 8 | field. Component c of a type is field
+		// FirstColumn + 2c, the y half of a 2D column the one after it.
+		enum Field : uint32_t {
+			Entities,
+			Sparse,
+			Generations,
+			FreeIds,
+			FirstColumn = 16
+		};
+		constexpr uint32_t Wells = 0xFF00;
+		constexpr uint32_t PolicyState = 0xFF01;
+
+		constexpr uint32_t kindOf(const ecs::EntityType type, const uint32_t field) {
+			return static_cast<uint32_t>(type) << 8 | field;
+		}
+
+		constexpr uint32_t columnField(const ecs::ComponentType component, const uint32_t half = 0) {
+			return FirstColumn + 2 * static_cast<uint32_t>(component) + half;
+		}
+
+		size_t alignUp(const size_t offset) {
+			return (offset + Alignment - 1) / Alignment * Alignment;
+		}
+
+		struct Source {
+			uint32_t kind;
+			uint32_t elementSize;
+			size_t count;
+			const void* data;
+		};
+
+		template <typename T>
+		Source source(const uint32_t kind, const std::vector<T>& values) {
+			static_assert(std::is_trivially_copyable<T>::value, "sections are raw arrays");
+			return { kind, sizeof(T), values.size(), values.data() };
+		}
+
+		template <ecs::EntityType E, ecs::ComponentType C>
+		void addColumn(const ECS& ecs, std::vector<Source>& sources) {
+			const auto& column = ecs.data<E, C>();
+			if constexpr (std::is_same<ecs::ColumnT<C>, ecs::Vec2Column>::value) {
+				sources.push_back(source(kindOf(E, columnField(C)), column.x));
+				sources.push_back(source(kindOf(E, columnField(C, 1)), column.y));
+			}
+			else {
+				sources.push_back(source(kindOf(E, columnField(C)), column));
+			}
+		}
+
+		template <ecs::EntityType E, size_t... C>
+		void addTable(const ECS& ecs, std::vector<Source>& sources, std::index_sequence<C...>) {
+			const auto& slots = ecs.slots<E>();
+			sources.push_back(source(kindOf(E, Entities), ecs.entities<E>()));
+			sources.push_back(source(kindOf(E, Sparse), slots.sparse));
+			sources.push_back(source(kindOf(E, Generations), slots.generations));
+			sources.push_back(source(kindOf(E, FreeIds), slots.freeIds));
+			(addColumn<E, static_cast<ecs::ComponentType>(C)>(ecs, sources), ...);
+		}
+
+		template <size_t... E>
+		void addTables(const ECS& ecs, std::vector<Source>& sources, std::index_sequence<E...>) {
+			(addTable<static_cast<ecs::EntityType>(E)>(ecs, sources, std::make_index_sequence<ecs::ComponentTypeCount>{}), ...);
+		}
+
+		// Checks the sections against the header and queues one copy per array into a new world.
+		struct Loader {
+			const MappedFile& file;
+			std::map<uint32_t, SectionEntry> sections;
+			std::vector<std::function<void()>> copies;
+			std::string error;
+
+			explicit Loader(const MappedFile& file)
+				: file{ file } {
+			}
+
+			static constexpr size_t AnyCount = ~size_t(0);
+
+			template <typename T>
+			bool read(const uint32_t kind, std::vector<T>& out, const size_t count = AnyCount) {
+				const auto found = sections.find(kind);
+				if (found == sections.end()) {
+					error = "section " + std::to_string(kind) + " is missing";
+					return false;
+				}
+				const auto& section = found->second;
+				const bool fits = section.offset <= file.size() && section.count <= (file.size() - section.offset) / sizeof(T);
+				if (section.elementSize != sizeof(T) || section.offset % alignof(T) != 0 || !fits || (count != AnyCount && section.count != count)) {
+					error = "section " + std::to_string(kind) + " is damaged";
+					return false;
+				}
+				const auto* first = reinterpret_cast<const T*>(file.data() + section.offset);
+				const auto size = static_cast<size_t>(section.count);
+				copies.push_back([&out, first, size] { out.assign(first, first + size); });
+				return true;
+			}
+
+			template <ecs::EntityType E, ecs::ComponentType C>
+			bool readColumn(ECS& ecs, const size_t count) {
+				auto& column = ecs.data<E, C>();
+				if constexpr (std::is_same<ecs::ColumnT<C>, ecs::Vec2Column>::value) {
+					return read(kindOf(E, columnField(C)), column.x, count) && read(kindOf(E, columnField(C, 1)), column.y, count);
+				}
+				else {
+					return read(kindOf(E, columnField(C)), column, count);
+				}
+			}
+
+			template <ecs::EntityType E, size_t... C>
+			bool readTable(ECS& ecs, std::index_sequence<C...>) {
+				const auto found = sections.find(kindOf(E, Entities));
+				if (found == sections.end()) {
+					error = "section " + std::to_string(kindOf(E, Entities)) + " is missing";
+					return false;
+				}
+				const auto count = static_cast<size_t>(found->second.count);
+				auto& slots = ecs.slots<E>();
+				const auto slotCount = sections.count(kindOf(E, Sparse)) ? static_cast<size_t>(sections[kindOf(E, Sparse)].count) : 0;
+				return read(kindOf(E, Entities), ecs.entities<E>(), count)
+					&& read(kindOf(E, Sparse), slots.sparse)
+					&& read(kindOf(E, Generations), slots.generations, slotCount)
+					&& read(kindOf(E, FreeIds), slots.freeIds)
+					&& (readColumn<E, static_cast<ecs::ComponentType>(C)>(ecs, count) && ...);
+			}
+
+			template <size_t... E>
+			bool readTables(ECS& ecs, std::index_sequence<E...>) {
+				return (readTable<static_cast<ecs::EntityType>(E)>(ecs, std::make_index_sequence<ecs::ComponentTypeCount>{}) && ...);
+			}
+		};
+
+		// Handles and slots must agree, or a later lookup would index out of bounds.
+		template <ecs::EntityType E>
+		bool consistent(const ECS& ecs) {
+			const auto& entities = ecs.entities<E>();
+			const auto& slots = ecs.slots<E>();
+			size_t live = 0;
+			for (const auto index : slots.sparse) {
+				if (index != ecs::InvalidIndex) {
+					if (index >= entities.size()) {
+						return false;
+					}
+					++live;
+				}
+			}
+			for (size_t i = 0; i < entities.size(); ++i) {
+				const auto& handle = entities[i];
+				if (handle.type != E || handle.id >= slots.sparse.size() || slots.sparse[handle.id] != i || slots.generations[handle.id] != handle.generation) {
+					return false;
+				}
+			}
+			for (const auto id : slots.freeIds) {
+				if (id >= slots.sparse.size() || slots.sparse[id] != ecs::InvalidIndex) {
+					return false;
+				}
+			}
+			return live == entities.size();
+		}
+
+		template <size_t... E>
+		bool consistentTables(const ECS& ecs, std::index_sequence<E...>) {
+			return (consistent<static_cast<ecs::EntityType>(E)>(ecs) && ...);
+		}
+
+		// room for every slot on the free lists, as a world that grew them itself has
+		template <size_t... E>
+		void reserveFreeIds(ECS& ecs, std::index_sequence<E...>) {
+			(ecs.slots<static_cast<ecs::EntityType>(E)>().freeIds.reserve(ecs.slots<static_cast<ecs::EntityType>(E)>().sparse.size()), ...);
+		}
+	}
+
+	bool saveCheckpoint(const World& world, const std::string& path) {
+		std::vector<Source> sources;
+		addTables(world.ecs, sources, std::make_index_sequence<ecs::EntityTypeCount>{});
+		sources.push_back(source(Wells, world.wells));
+		std::vector<uint8_t> policyState;
+		if (world.policy && world.policy->saveState(policyState)) {
+			sources.push_back(source(PolicyState, policyState));
+		}
+
+		Header header{};
+		std::memcpy(header.magic, Magic, sizeof(Magic));
+		header.version = Version;
+		header.byteOrder = ByteOrderMark;
+		header.sectionCount = static_cast<uint32_t>(sources.size());
+		header.tick = world.tick;
+		header.seed = world.seed;
+		header.width = static_cast<uint32_t>(world.width);
+		header.height = static_cast<uint32_t>(world.height);
+		header.integrator = static_cast<uint32_t>(world.integrator);
+		header.shipContacts = world.collisions.shipContacts;
+		header.particleContacts = world.collisions.particleContacts;
+
+		std::vector<SectionEntry> table;
+		size_t offset = alignUp(sizeof(Header) + sources.size() * sizeof(SectionEntry));
+		for (const auto& s : sources) {
+			table.push_back({ s.kind, s.elementSize, s.count, offset });
+			offset = alignUp(offset + s.count * s.elementSize);
+		}
+
+		// written next to the target and renamed over it, so a crash never leaves half a checkpoint
+		const auto partial = path + ".partial";
+		{
+			std::ofstream file(partial, std::ios::binary | std::ios::trunc);
+			if (!file) {
+				return false;
+			}
+			file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SectionEntry));
+			size_t written = sizeof(header) + table.size() * sizeof(SectionEntry);
+			const char padding[Alignment] = {};
+			for (size_t i = 0; i < sources.size(); ++i) {
+				file.write(padding, table[i].offset - written);
+				file.write(static_cast<const char*>(sources[i].data), sources[i].count * sources[i].elementSize);
+				written = table[i].offset + sources[i].count * sources[i].elementSize;
+			}
+			if (!file) {
+				std::remove(partial.c_str());
+				return false;
+			}
+		}
+		if (std::rename(partial.c_str(), path.c_str()) != 0) {
+			// Windows does not rename over an existing file
+			std::remove(path.c_str());
+			return std::rename(partial.c_str(), path.c_str()) == 0;
+		}
+		return true;
+	}
+
+	bool loadCheckpoint(const std::string& path, World& world, std::string& error) {
+		const auto file = MappedFile::open(path);
+		if (!file) {
+			error = "cannot open " + path;
+			return false;
+		}
+		Header header;
+		if (file->size() < sizeof(Header)) {
+			error = "not a checkpoint";
+			return false;
+		}
+		std::memcpy(&header, file->data(), sizeof(header));
+		if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0) {
+			error = "not a checkpoint";
+			return false;
+		}
+		if (header.version != Version) {
+			error = "unsupported checkpoint version " + std::to_string(header.version);
+			return false;
+		}
+		if (header.byteOrder != ByteOrderMark) {
+			error = "checkpoint was written with the other byte order";
+			return false;
+		}
+		if (header.sectionCount > MaxSections || file->size() < sizeof(Header) + header.sectionCount * sizeof(SectionEntry)) {
+			error = "checkpoint is truncated";
+			return false;
+		}
+
+		if (header.integrator > static_cast<uint32_t>(Integrator::Simd)) {
+			error = "unknown integrator " + std::to_string(header.integrator);
+			return false;
+		}
+
+		Loader loader(*file);
+		for (uint32_t i = 0; i < header.sectionCount; ++i) {
+			SectionEntry entry;
+			std::memcpy(&entry, file->data() + sizeof(Header) + i * sizeof(SectionEntry), sizeof(entry));
+			loader.sections[entry.kind] = entry;
+		}
+
+		World loaded = createWorld(header.width, header.height, 0, 0, header.seed);
+		loaded.tick = header.tick;
+		loaded.integrator = static_cast<Integrator>(header.integrator);
+		loaded.collisions.shipContacts = header.shipContacts;
+		loaded.collisions.particleContacts = header.particleContacts;
+		loaded.policy.reset();
+		std::vector<uint8_t> policyState;
+		const bool hasPolicy = loader.sections.count(PolicyState) != 0;
+		if (!loader.readTables(loaded.ecs, std::make_index_sequence<ecs::EntityTypeCount>{}) || !loader.read(Wells, loaded.wells)
+			|| (hasPolicy && !loader.read(PolicyState, policyState))) {
+			error = loader.error;
+			return false;
+		}
+
+		// the arrays are independent, copy them side by side
+		auto& jobs = JobSystem::instance();
+		JobSystem::Counter copied;
+		for (const auto& copy : loader.copies) {
+			jobs.run(copied, copy);
+		}
+		jobs.wait(copied);
+
+		if (!consistentTables(loaded.ecs, std::make_index_sequence<ecs::EntityTypeCount>{})) {
+			error = "entity handles do not match their slots";
+			return false;
+		}
+		reserveFreeIds(loaded.ecs, std::make_index_sequence<ecs::EntityTypeCount>{});
+		if (hasPolicy) {
+			loaded.policy = std::make_unique<MarkovPolicy>(loaded.seed);
+			if (!loaded.policy->loadState(policyState.data(), policyState.size())) {
+				error = "policy state is damaged";
+				return false;
+			}
+		}
+		// the lifecycle tops the particles up to what there was at every tick's end
+		loaded.particles.capacity = loaded.ecs.entities<ecs::EntityType::Square>().size();
+		world = std::move(loaded);
+		return true;
+	}
+}
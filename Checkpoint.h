@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+struct World;
+
+namespace GameJamAsteroids {
+	// World checkpoints. The file is a fixed header, a table of sections and then the sections
+	// themselves, each one raw array starting on a 64-byte boundary: the entity handles, slot
+	// bookkeeping and every component column of every entity type (2D columns as separate x and
+	// y arrays), the gravity wells and the policy state. Values are in host byte order; the
+	// header records it and other hosts refuse the file.
+	//
+	// Loading maps the file and copies each array straight into its column, one job per array,
+	// so nothing is parsed per entity and a multi-million-particle world loads at memory speed.
+	bool saveCheckpoint(const World& world, const std::string& path);
+	// Replaces world with the checkpoint. On failure world is left as it was and error says why.
+	bool loadCheckpoint(const std::string& path, World& world, std::string& error);
+}
@@ -0,0 +1,105 @@
+#include <Collision.h>
+#include <World.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace GameJamAsteroids {
+	namespace {
+		// ships push each other apart, so even a crowded fleet keeps to a few contacts per ship;
+		// room for this many up front keeps the broadphase from allocating
+		constexpr size_t ContactsPerShip = 8;
+
+		float wrapDelta(float delta, const float size) {
+			if (delta > 0.5f * size) {
+				delta -= size;
+			}
+			else if (delta < -0.5f * size) {
+				delta += size;
+			}
+			return delta;
+		}
+
+		float wrapCoordinate(float value, const float size) {
+			value = std::fmod(value, size);
+			return value < 0.0f ? value + size : value;
+		}
+
+		void resolveShipContacts(World& world) {
+			const auto width = static_cast<float>(world.width);
+			const auto height = static_cast<float>(world.height);
+
+			auto& positions = world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+			auto& speeds = world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Speed>();
+			world.shipGrid.update(positions.x.data(), positions.y.data(), positions.size());
+			world.shipPairs.reserve(ContactsPerShip * positions.size());
+			world.shipGrid.broadphasePairs(2.0f * ShipRadius, world.shipPairs);
+			// cell order depends on how ships moved before, resolve in index order so a run
+			// restored from a keyframe pushes ships exactly as the original did
+			std::sort(world.shipPairs.begin(), world.shipPairs.end());
+
+			for (const auto& pair : world.shipPairs) {
+				const auto a = pair.first;
+				const auto b = pair.second;
+				float dx = wrapDelta(positions.x[b] - positions.x[a], width);
+				float dy = wrapDelta(positions.y[b] - positions.y[a], height);
+				float distance = std::sqrt(dx * dx + dy * dy);
+				if (distance < 0.0001f) {
+					dx = 1.0f;
+					dy = 0.0f;
+					distance = 1.0f;
+				}
+
+				// split the overlap between both ships along the contact normal
+				const float push = 0.5f * (2.0f * ShipRadius - distance) / distance;
+				positions.x[a] = wrapCoordinate(positions.x[a] - push * dx, width);
+				positions.y[a] = wrapCoordinate(positions.y[a] - push * dy, height);
+				positions.x[b] = wrapCoordinate(positions.x[b] + push * dx, width);
+				positions.y[b] = wrapCoordinate(positions.y[b] + push * dy, height);
+				speeds[a] *= 0.5f;
+				speeds[b] *= 0.5f;
+			}
+			world.collisions.shipContacts += world.shipPairs.size();
+		}
+
+		void resolveParticleContacts(World& world) {
+			auto& positions = world.ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
+			auto& velocities = world.ecs.data<ecs::EntityType::Square, ecs::ComponentType::Velocity>();
+			if (positions.empty()) {
+				return;
+			}
+
+			const auto width = static_cast<float>(world.width);
+			const auto height = static_cast<float>(world.height);
+			world.particleGrid.update(positions.x.data(), positions.y.data(), positions.size());
+
+			const auto& ships = world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+			for (size_t i = 0; i < ships.size(); ++i) {
+				const ecs::Vec2f shipPos = ships[i];
+				world.particleGrid.queryRadius(shipPos.x, shipPos.y, ShipRadius, [&](const unsigned int k) {
+					const float dx = wrapDelta(positions.x[k] - shipPos.x, width);
+					const float dy = wrapDelta(positions.y[k] - shipPos.y, height);
+					const float distance = std::sqrt(dx * dx + dy * dy);
+					if (distance < 0.0001f) {
+						return;
+					}
+
+					// reflect the velocity when the particle is heading into the hull
+					const float nx = dx / distance;
+					const float ny = dy / distance;
+					const float approach = velocities.x[k] * nx + velocities.y[k] * ny;
+					if (approach < 0.0f) {
+						velocities.x[k] -= 2.0f * approach * nx;
+						velocities.y[k] -= 2.0f * approach * ny;
+						++world.collisions.particleContacts;
+					}
+				});
+			}
+		}
+	}
+
+	void resolveCollisions(World& world) {
+		resolveShipContacts(world);
+		resolveParticleContacts(world);
+	}
+}
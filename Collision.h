@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+struct World;
+
+namespace GameJamAsteroids {
+	constexpr float ShipRadius = 25.0f;
+	constexpr float ShipGridCell = 64.0f;
+	constexpr float ParticleGridCell = 32.0f;
+
+	struct CollisionStats {
+		size_t shipContacts{ 0 };
+		size_t particleContacts{ 0 };
+	};
+
+	// Refreshes the ship and particle grids, then pushes overlapping ships apart (bleeding off
+	// speed) and bounces particles off ship hulls. Counts are added to world.collisions.
+	void resolveCollisions(World& world);
+}
@@ -1,44 +1,163 @@
 #pragma once
 
-#include <unordered_map>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <glm/vec3.hpp>
+#include <EcsColumns.h>
 #include <EcsTypes.h>
+#include <JobSystem.h>
+
+namespace ecs {
+
+// Per-column initializer for ECS::createEntities. fill(out, first, count) writes count values
+// through out[0..count) (a pointer, or an ecs::Vec2Pointer for split columns); first is the
+// offset of out within the spawned batch. Columns and chunks run in parallel.
+template <ComponentType C, typename F>
+struct ColumnInit {
+	static constexpr ComponentType component = C;
+	F fill;
+};
+
+template <ComponentType C, typename F>
+ColumnInit<C, std::decay_t<F>> column(F&& fill) {
+	return { std::forward<F>(fill) };
+}
+
+}
 
 class ECS {
 public:
 	ECS() = default;
 
-	ecs::EntityHandle createEntity(const ecs::EntityType type, ecs::Vec3f color);
-	std::vector<ecs::EntityHandle> createEntity(const ecs::EntityType type, ecs::Vec3f color, size_t count);
+	ecs::EntityHandle createEntity(const ecs::EntityType type, ecs::Color color);
+	std::vector<ecs::EntityHandle> createEntity(const ecs::EntityType type, ecs::Color color, size_t count);
+	// Bulk spawn: reserves every column once, default-fills it and runs the given ecs::column<C>
+	// initializers over it in parallel chunks. Returns the dense range of the new entities.
+	template <ecs::EntityType E, typename... Inits>
+	ecs::EntityRange createEntities(size_t count, const Inits&... inits);
+	bool destroyEntity(const ecs::EntityHandle handle);
+	bool isAlive(const ecs::EntityHandle handle) const;
+	// dense index of a live entity into its type's component columns, InvalidIndex otherwise
+	unsigned int indexOf(const ecs::EntityHandle handle) const;
+
 	template <ecs::EntityType E, ecs::ComponentType C>
-	std::vector<ecs::Vec3f>& data();
+	ecs::ColumnT<C>& data();
+	template <ecs::EntityType E, ecs::ComponentType C>
+	const ecs::ColumnT<C>& data() const;
+	// handles of the live entities of type E, in the same order as the component columns
 	template <ecs::EntityType E>
 	std::vector<ecs::EntityHandle>& entities();
+	template <ecs::EntityType E>
+	const std::vector<ecs::EntityHandle>& entities() const;
+
+	// Slot bookkeeping behind the handles of one entity type. Checkpoints save and restore it
+	// together with entities() and the columns.
+	struct Slots {
+		// slot id -> dense index, InvalidIndex for free slots
+		std::vector<unsigned int> sparse;
+		std::vector<unsigned int> generations;
+		std::vector<unsigned int> freeIds;
+	};
+	template <ecs::EntityType E>
+	Slots& slots();
+	template <ecs::EntityType E>
+	const Slots& slots() const;
+
+	static constexpr size_t SpawnChunkSize = 16384;
 
 private:
-	using EntityMap = std::unordered_map<ecs::EntityType, std::vector<ecs::EntityHandle>>;
-	using ComponentDataMap = std::unordered_map<ecs::ComponentType, std::vector<ecs::Vec3f>>;
-	using ECDataMap = std::unordered_map<ecs::EntityType, ComponentDataMap>;
-	EntityMap mEntities;
-	ECDataMap mECData;
+	template <typename Sequence>
+	struct ColumnTuple;
+	template <size_t... C>
+	struct ColumnTuple<std::index_sequence<C...>> {
+		using type = std::tuple<ecs::ColumnT<static_cast<ecs::ComponentType>(C)>...>;
+	};
+	using Columns = typename ColumnTuple<std::make_index_sequence<ecs::ComponentTypeCount>>::type;
+
+	// One table per entity type, one column per component type, both addressed by enum value.
+	// Live entities are packed at the front of every column; sparse maps slot id -> dense index.
+	struct Table {
+		std::vector<ecs::EntityHandle> entities;
+		Columns columns;
+		Slots slots;
+
+		template <ecs::ComponentType C>
+		ecs::ColumnT<C>& column() {
+			return std::get<static_cast<size_t>(C)>(columns);
+		}
+
+		unsigned int acquireId() {
+			if (!slots.freeIds.empty()) {
+				const auto id = slots.freeIds.back();
+				slots.freeIds.pop_back();
+				return id;
+			}
+			slots.sparse.push_back(ecs::InvalidIndex);
+			slots.generations.push_back(0);
+			// every slot fits on the free list, so destroying an entity never allocates
+			slots.freeIds.reserve(slots.sparse.capacity());
+			return static_cast<unsigned int>(slots.sparse.size() - 1);
+		}
+	};
+
+	template <ecs::ComponentType C>
+	static ecs::ComponentT<C> defaultValue() {
+		if constexpr (C == ecs::ComponentType::Size) {
+			return { 1.0f, 1.0f };
+		}
+		else if constexpr (C == ecs::ComponentType::AngularVelocity) {
+			return 0.0001f;
+		}
+		else {
+			return {};
+		}
+	}
+
+	template <size_t... C>
+	static void resizeColumns(Table& t, const size_t size, std::index_sequence<C...>) {
+		(t.column<static_cast<ecs::ComponentType>(C)>().resize(size, defaultValue<static_cast<ecs::ComponentType>(C)>()), ...);
+	}
+
+	template <ecs::ComponentType C, typename F>
+	static void fillColumn(Table& t, const size_t begin, const size_t count, const ecs::ColumnInit<C, F>& init) {
+		const auto out = t.column<C>().data() + begin;
+		JobSystem::instance().parallelFor(count, SpawnChunkSize, [&](const size_t first, const size_t last) {
+			init.fill(out + first, first, last - first);
+		});
+	}
+
+	Table& table(const ecs::EntityType type) {
+		return mTables[static_cast<size_t>(type)];
+	}
+
+	const Table& table(const ecs::EntityType type) const {
+		return mTables[static_cast<size_t>(type)];
+	}
+
+	std::array<Table, ecs::EntityTypeCount> mTables;
 };
 
-inline ecs::EntityHandle ECS::createEntity(const ecs::EntityType type, ecs::Vec3f color) {
-	auto& container = mEntities[type];
-	container.emplace_back(type, ecs::TypeIdBand * static_cast<int>(type) + container.size(), 0);
-	auto entityId = container.size();
+inline ecs::EntityHandle ECS::createEntity(const ecs::EntityType type, ecs::Color color) {
+	auto& t = table(type);
+	const auto id = t.acquireId();
+
+	auto& container = t.entities;
+	t.slots.sparse[id] = static_cast<unsigned int>(container.size());
+	container.emplace_back(type, id, t.slots.generations[id]);
 	switch (type) {
 	case ecs::EntityType::Particle:
 		[[fallthrough]];
 	case ecs::EntityType::Square:
 		[[fallthrough]];
 	case ecs::EntityType::Circle:
-		mECData[type][ecs::ComponentType::Position].push_back({ 0.0f, 0.0f, 0.0f });
-		mECData[type][ecs::ComponentType::Velocity].push_back({ 0.0f, 0.0f, 0.0f });
-		mECData[type][ecs::ComponentType::Color].push_back(color);
-		mECData[type][ecs::ComponentType::Size].push_back({ 1.0f, 1.0f, 0.0f });
-		mECData[type][ecs::ComponentType::AngularVelocity].push_back({ 0.0f, 0.0f, 0.0001f });
+		[[fallthrough]];
+	case ecs::EntityType::Ship:
+		resizeColumns(t, container.size(), std::make_index_sequence<ecs::ComponentTypeCount>{});
+		t.column<ecs::ComponentType::Color>().back() = color;
 		break;
 	default:
 		break;
@@ -46,20 +165,113 @@ inline ecs::EntityHandle ECS::createEntity(const ecs::EntityType type, ecs::Vec3
 	return container.back();
 }
 
-inline std::vector<ecs::EntityHandle> ECS::createEntity(const ecs::EntityType type, ecs::Vec3f color, size_t count) {
+inline std::vector<ecs::EntityHandle> ECS::createEntity(const ecs::EntityType type, ecs::Color color, size_t count) {
 	std::vector<ecs::EntityHandle> handles;
+	handles.reserve(count);
+	auto& t = table(type);
+	t.entities.reserve(t.entities.size() + count);
+	std::apply([size = t.entities.size() + count](auto&... column) { (column.reserve(size), ...); }, t.columns);
 	for (; count > 0; --count) {
 		handles.push_back(createEntity(type, color));
 	}
 	return handles;
 }
 
+template <ecs::EntityType E, typename... Inits>
+inline ecs::EntityRange ECS::createEntities(size_t count, const Inits&... inits) {
+	auto& t = table(E);
+	const auto begin = t.entities.size();
+	const auto end = begin + count;
+
+	t.entities.reserve(end);
+	for (size_t i = begin; i < end; ++i) {
+		const auto id = t.acquireId();
+		t.slots.sparse[id] = static_cast<unsigned int>(i);
+		t.entities.emplace_back(E, id, t.slots.generations[id]);
+	}
+
+	resizeColumns(t, end, std::make_index_sequence<ecs::ComponentTypeCount>{});
+
+	// columns are independent, fill them side by side; each job captures two words so queueing
+	// it does not allocate
+	const auto fill = [&t, begin, count](const auto& init) { fillColumn(t, begin, count, init); };
+	auto& jobs = JobSystem::instance();
+	JobSystem::Counter filled;
+	(jobs.run(filled, [&fill, &inits] { fill(inits); }), ...);
+	jobs.wait(filled);
+
+	return { E, static_cast<unsigned int>(begin), static_cast<unsigned int>(end) };
+}
+
+inline bool ECS::destroyEntity(const ecs::EntityHandle handle) {
+	const auto index = indexOf(handle);
+	if (index == ecs::InvalidIndex) {
+		return false;
+	}
+
+	// swap the last live entity into the hole so every column stays dense
+	auto& t = table(handle.type);
+	const auto last = t.entities.size() - 1;
+	std::apply([index, last](auto&... column) {
+		auto swapRemove = [index, last](auto& c) {
+			// every column holds a value for every live entity
+			assert(c.size() == last + 1);
+			c[index] = std::move(c[last]);
+			c.pop_back();
+		};
+		(swapRemove(column), ...);
+	}, t.columns);
+
+	t.entities[index] = t.entities[last];
+	t.entities.pop_back();
+	if (index != last) {
+		t.slots.sparse[t.entities[index].id] = index;
+	}
+
+	t.slots.sparse[handle.id] = ecs::InvalidIndex;
+	++t.slots.generations[handle.id];
+	t.slots.freeIds.push_back(handle.id);
+	return true;
+}
+
+inline bool ECS::isAlive(const ecs::EntityHandle handle) const {
+	return indexOf(handle) != ecs::InvalidIndex;
+}
+
+inline unsigned int ECS::indexOf(const ecs::EntityHandle handle) const {
+	const auto& t = table(handle.type);
+	if (handle.id >= t.slots.sparse.size() || t.slots.generations[handle.id] != handle.generation) {
+		return ecs::InvalidIndex;
+	}
+	return t.slots.sparse[handle.id];
+}
+
+template <ecs::EntityType E, ecs::ComponentType C>
+inline ecs::ColumnT<C>& ECS::data() {
+	return std::get<static_cast<size_t>(C)>(mTables[static_cast<size_t>(E)].columns);
+}
+
 template <ecs::EntityType E, ecs::ComponentType C>
-inline std::vector<ecs::Vec3f>& ECS::data() {
-	return mECData[E][C];
+inline const ecs::ColumnT<C>& ECS::data() const {
+	return std::get<static_cast<size_t>(C)>(mTables[static_cast<size_t>(E)].columns);
 }
 
 template<ecs::EntityType E>
 inline std::vector<ecs::EntityHandle>& ECS::entities() {
-	return mEntities[E];
+	return mTables[static_cast<size_t>(E)].entities;
+}
+
+template<ecs::EntityType E>
+inline const std::vector<ecs::EntityHandle>& ECS::entities() const {
+	return mTables[static_cast<size_t>(E)].entities;
+}
+
+template<ecs::EntityType E>
+inline ECS::Slots& ECS::slots() {
+	return mTables[static_cast<size_t>(E)].slots;
+}
+
+template<ecs::EntityType E>
+inline const ECS::Slots& ECS::slots() const {
+	return mTables[static_cast<size_t>(E)].slots;
 }
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <EcsTypes.h>
+#include <cstddef>
+#include <vector>
+
+namespace ecs {
+
+// Structure-of-arrays storage for 2D vector components. x and y live in separate float arrays
+// so kernels can stream them with SIMD loads; element access goes through a small proxy.
+struct Vec2Ref {
+	float& x;
+	float& y;
+
+	Vec2Ref& operator=(const Vec2f& v) {
+		x = v.x;
+		y = v.y;
+		return *this;
+	}
+
+	Vec2Ref& operator=(const Vec2Ref& other) {
+		x = other.x;
+		y = other.y;
+		return *this;
+	}
+
+	operator Vec2f() const {
+		return { x, y };
+	}
+};
+
+struct Vec2Pointer {
+	float* x;
+	float* y;
+
+	Vec2Ref operator[](const size_t i) const {
+		return { x[i], y[i] };
+	}
+
+	Vec2Pointer operator+(const size_t n) const {
+		return { x + n, y + n };
+	}
+};
+
+struct Vec2Column {
+	using value_type = Vec2f;
+
+	std::vector<float> x;
+	std::vector<float> y;
+
+	size_t size() const { return x.size(); }
+	bool empty() const { return x.empty(); }
+
+	void reserve(const size_t n) {
+		x.reserve(n);
+		y.reserve(n);
+	}
+
+	void resize(const size_t n, const Vec2f value = {}) {
+		x.resize(n, value.x);
+		y.resize(n, value.y);
+	}
+
+	void push_back(const Vec2f value) {
+		x.push_back(value.x);
+		y.push_back(value.y);
+	}
+
+	void pop_back() {
+		x.pop_back();
+		y.pop_back();
+	}
+
+	Vec2Ref operator[](const size_t i) {
+		return { x[i], y[i] };
+	}
+
+	Vec2f operator[](const size_t i) const {
+		return { x[i], y[i] };
+	}
+
+	Vec2Ref back() {
+		return { x.back(), y.back() };
+	}
+
+	Vec2Pointer data() {
+		return { x.data(), y.data() };
+	}
+};
+
+// Column container used for a component: std::vector by default, split storage for 2D kinematics.
+template <ComponentType C>
+struct ColumnTraits {
+	using type = std::vector<ComponentT<C>>;
+};
+template <> struct ColumnTraits<ComponentType::Position> { using type = Vec2Column; };
+template <> struct ColumnTraits<ComponentType::Velocity> { using type = Vec2Column; };
+
+template <ComponentType C>
+using ColumnT = typename ColumnTraits<C>::type;
+
+}
@@ -1,19 +1,45 @@
 #pragma once
 
+#include <SFML/System/Vector2.hpp>
 #include <SFML/System/Vector3.hpp> 
+#include <SFML/Graphics/Color.hpp>
+#include <cstddef>
 
 namespace ecs {
 
 enum class EntityType: int {
 	Square,
 	Circle,
-	Particle
+	Particle,
+	Ship
 };
+constexpr size_t EntityTypeCount = 4;
+
+// Handles are (type, slot id, generation). A slot id is reused after its entity is destroyed,
+// the generation is bumped so stale handles no longer resolve.
 struct EntityHandle { 
-	EntityHandle(const EntityType t, unsigned int id, unsigned int ttl) : type(t), id(id), ttl(ttl) {}
-	EntityType type; 
+	EntityHandle() = default;
+	EntityHandle(const EntityType t, unsigned int id, unsigned int generation) : type(t), id(id), generation(generation) {}
+	EntityType type{ EntityType::Square }; 
 	unsigned int id{ 0 };
-	unsigned int ttl; 
+	unsigned int generation{ 0 };
+};
+
+inline bool operator==(const EntityHandle& a, const EntityHandle& b) {
+	return a.type == b.type && a.id == b.id && a.generation == b.generation;
+}
+
+inline bool operator!=(const EntityHandle& a, const EntityHandle& b) {
+	return !(a == b);
+}
+
+// Dense index range [begin, end) of entities spawned together, valid until the next destroy of that type.
+struct EntityRange {
+	EntityType type{ EntityType::Square };
+	unsigned int begin{ 0 };
+	unsigned int end{ 0 };
+
+	size_t size() const { return end - begin; }
 };
 
 enum class ComponentType : int {
@@ -21,16 +47,43 @@ enum class ComponentType : int {
 	Velocity,
 	Color,
 	Size,
-	AngularVelocity
+	AngularVelocity,
+	TimeToLive,
+	Heading,
+	Speed,
+	Acceleration
 };
+constexpr size_t ComponentTypeCount = 9;
 
-constexpr unsigned int TypeIdBand = 1000000;
+constexpr unsigned int InvalidIndex = ~0u;
 
+using Vec2f = sf::Vector2f;
 using Vec3f = sf::Vector3f;
 
-using Position = Vec3f;
-using Velocity = Vec3f;
-using Color = Vec3f;
+using Position = Vec2f;
+using Velocity = Vec2f;
+using Color = sf::Color;
+using Size = Vec2f;
+using AngularVelocity = float;
+using TimeToLive = unsigned int;
+using Heading = float;
+using Speed = float;
+using Acceleration = float;
+
+// Maps a ComponentType to the value type stored in its column.
+template <ComponentType C> struct ComponentTraits;
+template <> struct ComponentTraits<ComponentType::Position> { using type = Position; };
+template <> struct ComponentTraits<ComponentType::Velocity> { using type = Velocity; };
+template <> struct ComponentTraits<ComponentType::Color> { using type = Color; };
+template <> struct ComponentTraits<ComponentType::Size> { using type = Size; };
+template <> struct ComponentTraits<ComponentType::AngularVelocity> { using type = AngularVelocity; };
+template <> struct ComponentTraits<ComponentType::TimeToLive> { using type = TimeToLive; };
+template <> struct ComponentTraits<ComponentType::Heading> { using type = Heading; };
+template <> struct ComponentTraits<ComponentType::Speed> { using type = Speed; };
+template <> struct ComponentTraits<ComponentType::Acceleration> { using type = Acceleration; };
+
+template <ComponentType C>
+using ComponentT = typename ComponentTraits<C>::type;
 
 struct Square {
 	Vec3f position;
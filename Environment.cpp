@@ -0,0 +1,117 @@
+#include <Environment.h>
+#include <GameLoop.h>
+#include <JobSystem.h>
+#include <Renderer.h>
+#include <ShipSystem.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+namespace GameJamAsteroids {
+	VectorEnvironment::VectorEnvironment(const size_t worldCount, const EnvironmentOptions& options)
+		: mOptions{ options }
+		, mObservations(worldCount * options.shipCount * ObservationSize)
+		, mRewards(worldCount * options.shipCount)
+		, mSteering(worldCount * options.shipCount, SteeringState::Continue)
+		, mSpeed(worldCount * options.shipCount, SpeedState::Continue) {
+		mWorlds.resize(worldCount);
+		mCustomPolicy.resize(worldCount, false);
+		reset();
+	}
+
+	void VectorEnvironment::setPolicy(const size_t world, std::unique_ptr<IPolicy> policy) {
+		mWorlds[world].policy = std::move(policy);
+		mCustomPolicy[world] = true;
+	}
+
+	void VectorEnvironment::reset() {
+		JobSystem::instance().parallelFor(mWorlds.size(), 1, [&](const size_t begin, const size_t end) {
+			for (size_t w = begin; w < end; ++w) {
+				// a policy the caller set, or its absence, survives; the default one starts over
+				auto policy = std::move(mWorlds[w].policy);
+				mWorlds[w] = createWorld(mOptions.width, mOptions.height, mOptions.shipCount, mOptions.quadCount, mOptions.seed + w);
+				mWorlds[w].integrator = mOptions.integrator;
+				if (mCustomPolicy[w]) {
+					mWorlds[w].policy = std::move(policy);
+				}
+				observe(w);
+			}
+		});
+		std::fill(mRewards.begin(), mRewards.end(), 0.0f);
+		mTicks = 0;
+	}
+
+	void VectorEnvironment::step() {
+		const auto dt = GameLoop::FixedStep;
+		JobSystem::instance().parallelFor(mWorlds.size(), 1, [&](const size_t begin, const size_t end) {
+			for (size_t w = begin; w < end; ++w) {
+				auto& world = mWorlds[w];
+				if (!world.policy) {
+					const auto first = w * mOptions.shipCount;
+					world.shipActions.resize(mOptions.shipCount);
+					std::copy_n(mSteering.begin() + first, mOptions.shipCount, world.shipActions.steering.begin());
+					std::copy_n(mSpeed.begin() + first, mOptions.shipCount, world.shipActions.speed.begin());
+				}
+				GameLoop::step(world, dt);
+				observe(w);
+				reward(w, dt);
+			}
+		});
+		++mTicks;
+	}
+
+	void VectorEnvironment::observe(const size_t index) {
+		const auto& world = mWorlds[index];
+		const auto ships = observeShips(world.ecs, world.width, world.height);
+		float* out = mObservations.data() + index * mOptions.shipCount * ObservationSize;
+		for (size_t i = 0; i < ships.count; ++i, out += ObservationSize) {
+			out[0] = ships.x[i] / ships.width;
+			out[1] = ships.y[i] / ships.height;
+			out[2] = std::cos(ships.heading[i]);
+			out[3] = std::sin(ships.heading[i]);
+			out[4] = ships.speed[i];
+		}
+	}
+
+	void VectorEnvironment::reward(const size_t index, const float dt) {
+		const auto& world = mWorlds[index];
+		const auto& speeds = world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Speed>();
+		float* out = mRewards.data() + index * mOptions.shipCount;
+		for (size_t i = 0; i < speeds.size(); ++i) {
+			out[i] = speeds[i] * dt;
+		}
+		for (const auto& pair : world.shipPairs) {
+			out[pair.first] -= ContactPenalty;
+			out[pair.second] -= ContactPenalty;
+		}
+	}
+
+	int runEnvironments(const size_t worldCount, const EnvironmentOptions& options, const size_t ticks) {
+		VectorEnvironment environment(worldCount, options);
+		std::vector<double> totals(worldCount, 0.0);
+
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t tick = 0; tick < ticks; ++tick) {
+			environment.step();
+			const auto& rewards = environment.rewards();
+			for (size_t w = 0; w < worldCount; ++w) {
+				const auto first = rewards.begin() + w * options.shipCount;
+				totals[w] += std::accumulate(first, first + options.shipCount, 0.0);
+			}
+		}
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		const double shipSteps = static_cast<double>(worldCount * options.shipCount * ticks);
+		std::cout << "environments: " << worldCount << " worlds x " << options.shipCount << " ships, " << options.quadCount << " particles each, " << ticks << " ticks, " << JobSystem::instance().threadCount() << " threads" << std::endl;
+		std::cout << "  wall time:          " << elapsed.count() << " s" << std::endl;
+		std::cout << "  world steps/sec:    " << worldCount * ticks / elapsed.count() << std::endl;
+		std::cout << "  ship steps/sec:     " << shipSteps / elapsed.count() << std::endl;
+		for (size_t w = 0; w < worldCount; ++w) {
+			std::cout << "  world " << w << " mean reward per ship: " << (options.shipCount > 0 ? totals[w] / options.shipCount : 0.0) << std::endl;
+		}
+		return 0;
+	}
+}
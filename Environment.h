@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Agent.h>
+#include <Random.h>
+#include <Simulation.h>
+#include <World.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace GameJamAsteroids {
+	struct EnvironmentOptions {
+		size_t width{ 2560 };
+		size_t height{ 1440 };
+		size_t shipCount{ 10 };
+		// 0 runs the worlds without a particle field
+		size_t quadCount{ 0 };
+		// world w is created from seed + w
+		uint64_t seed{ DefaultSeed };
+		Integrator integrator{ Integrator::Simd };
+	};
+
+	// M independent worlds stepped in lockstep, one job per world. After every step the
+	// observations and rewards of all ships are in flat arrays laid out [world][ship], allocated
+	// once when the environment is created.
+	//
+	// A world with a policy (each starts with its own MarkovPolicy) decides for itself. Setting a
+	// null policy hands its ships to the caller, who writes steering() and speed() before step().
+	class VectorEnvironment {
+	public:
+		// x / width, y / height, cos heading, sin heading, speed
+		static constexpr size_t ObservationSize = 5;
+		// subtracted from a ship's reward for every other ship it touched this step
+		static constexpr float ContactPenalty = 1.0f;
+
+		VectorEnvironment(const size_t worldCount, const EnvironmentOptions& options);
+
+		size_t worldCount() const { return mWorlds.size(); }
+		size_t shipsPerWorld() const { return mOptions.shipCount; }
+		size_t ticks() const { return mTicks; }
+
+		void setPolicy(const size_t world, std::unique_ptr<IPolicy> policy);
+		World& world(const size_t index) { return mWorlds[index]; }
+
+		// Recreates every world from its seed and refreshes the observations.
+		void reset();
+		// Advances every world one fixed step.
+		void step();
+
+		const std::vector<float>& observations() const { return mObservations; }
+		// distance flown this step, minus ContactPenalty per contact
+		const std::vector<float>& rewards() const { return mRewards; }
+		std::vector<SteeringState>& steering() { return mSteering; }
+		std::vector<SpeedState>& speed() { return mSpeed; }
+
+	private:
+		void observe(const size_t index);
+		void reward(const size_t index, const float dt);
+
+		EnvironmentOptions mOptions;
+		std::vector<World> mWorlds;
+		std::vector<bool> mCustomPolicy;
+		size_t mTicks{ 0 };
+
+		std::vector<float> mObservations;
+		std::vector<float> mRewards;
+		std::vector<SteeringState> mSteering;
+		std::vector<SpeedState> mSpeed;
+	};
+
+	// Steps worldCount worlds for the given ticks and prints throughput and mean reward.
+	int runEnvironments(const size_t worldCount, const EnvironmentOptions& options, const size_t ticks);
+}
@@ -0,0 +1,26 @@
+#include <FixedClock.h>
+
+FixedClock::FixedClock(const Duration step, const size_t maxCatchUpSteps)
+	: mStep{ step }
+	, mMaxCatchUpSteps{ maxCatchUpSteps } {
+}
+
+size_t FixedClock::advance(const Duration elapsed) {
+	mAccumulator += elapsed;
+	auto steps = static_cast<size_t>(mAccumulator / mStep);
+	mAccumulator -= mStep * static_cast<Duration::rep>(steps);
+	if (steps > mMaxCatchUpSteps) {
+		mDropped += steps - mMaxCatchUpSteps;
+		steps = mMaxCatchUpSteps;
+	}
+	mTicks += steps;
+	return steps;
+}
+
+float FixedClock::alpha() const {
+	return static_cast<float>(static_cast<double>(mAccumulator.count()) / mStep.count());
+}
+
+double FixedClock::seconds() const {
+	return std::chrono::duration<double>(mStep).count() * (mTicks + static_cast<double>(alpha()));
+}
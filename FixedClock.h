@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+// Accumulator for a fixed simulation step. Frames feed in the wall time that passed, the clock
+// answers how many whole steps to simulate and how far into the next step the frame is.
+class FixedClock {
+public:
+	using Duration = std::chrono::steady_clock::duration;
+
+	FixedClock(const Duration step, const size_t maxCatchUpSteps);
+
+	// Adds elapsed wall time and returns the number of steps due. After a stall at most
+	// maxCatchUpSteps are returned and the rest of the backlog is dropped.
+	size_t advance(const Duration elapsed);
+
+	// fraction of a step left in the accumulator, for interpolating between the last two ticks
+	float alpha() const;
+	size_t ticks() const { return mTicks; }
+	// simulated seconds, including the partial step
+	double seconds() const;
+	// steps thrown away by the catch-up limit
+	size_t droppedSteps() const { return mDropped; }
+
+private:
+	Duration mStep;
+	Duration mAccumulator{ 0 };
+	size_t mMaxCatchUpSteps;
+	size_t mTicks{ 0 };
+	size_t mDropped{ 0 };
+};
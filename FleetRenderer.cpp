@@ -0,0 +1,53 @@
+#include <FleetRenderer.h>
+
+#include <cmath>
+
+namespace {
+	constexpr float side = 10.0f;
+	const sf::Color hullColor{ 128, 128, 128 };
+
+	struct HullVertex {
+		float x;
+		float y;
+		// takes the ship color instead of the hull grey
+		bool tinted;
+	};
+
+	// ship facing +x around its position, as triangles
+	constexpr HullVertex hull[FleetRenderer::HullVertexCount] = {
+		// head
+		{ 2.0f * side, 0.0f, true }, { 0.0f, side, true }, { 0.0f, -side, true },
+		// body, two triangles makes a rectangle
+		{ -1.5f * side, -2.0f * side, false }, { 0.0f, -2.0f * side, false }, { -1.5f * side, 2.0f * side, false },
+		{ 0.0f, -2.0f * side, false }, { 0.0f, 2.0f * side, false }, { -1.5f * side, 2.0f * side, false },
+		// left wing
+		{ -1.5f * side, -3.0f * side, false }, { -1.5f * side, -2.0f * side, false }, { 0.0f, -2.0f * side, false },
+		// right wing
+		{ -1.5f * side, 3.0f * side, false }, { -1.5f * side, 2.0f * side, false }, { 0.0f, 2.0f * side, false },
+		// tail
+		{ -1.5f * side, 0.0f, false }, { -3.0f * side, 0.0f, false }, { -3.5f * side, -1.5f * side, false },
+		{ -1.5f * side, 0.0f, false }, { -3.0f * side, 0.0f, false }, { -3.5f * side, 1.5f * side, false },
+	};
+}
+
+void FleetRenderer::resize(const size_t count) {
+	mVertices.resize(count * HullVertexCount);
+}
+
+void FleetRenderer::setShip(const size_t index, const ecs::Vec3f position, const float heading, const sf::Color color) {
+	writeHull(mVertices.data() + index * HullVertexCount, position, heading, color);
+}
+
+void FleetRenderer::draw(RenderBackend& backend) const {
+	backend.draw(mVertices.data(), mVertices.size(), sf::Triangles);
+}
+
+void FleetRenderer::writeHull(sf::Vertex* out, const ecs::Vec3f position, const float heading, const sf::Color color) {
+	const float s = std::sin(heading);
+	const float c = std::cos(heading);
+	for (size_t i = 0; i < HullVertexCount; ++i) {
+		const auto& v = hull[i];
+		out[i].position = { position.x + v.x * c - v.y * s, position.y + v.x * s + v.y * c };
+		out[i].color = v.tinted ? color : hullColor;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <EcsTypes.h>
+#include <RenderBackend.h>
+#include <SFML/Graphics/Vertex.hpp>
+#include <vector>
+
+// Draws a whole fleet with one draw call. Hulls are a fixed local-space template, so a ship
+// costs one sin/cos pair plus a rotate and translate per vertex, written into storage that is
+// kept between frames.
+class FleetRenderer {
+public:
+	static constexpr size_t HullVertexCount = 21;
+
+	// Sizes the vertex array for count ships; call before setShip().
+	void resize(const size_t count);
+	// Safe to call from several threads for different ships.
+	void setShip(const size_t index, const ecs::Vec3f position, const float heading, const sf::Color color);
+	void draw(RenderBackend& backend) const;
+
+	size_t size() const { return mVertices.size() / HullVertexCount; }
+
+	// Writes HullVertexCount triangle vertices for one ship to out.
+	static void writeHull(sf::Vertex* out, const ecs::Vec3f position, const float heading, const sf::Color color);
+
+private:
+	std::vector<sf::Vertex> mVertices;
+};
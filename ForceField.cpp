@@ -0,0 +1,305 @@
+#include <ForceField.h>
+#include <JobSystem.h>
+#include <Simd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace GameJamAsteroids {
+	namespace {
+		// sources per tile, three floats each keeps a tile well inside L1
+		constexpr size_t SourceTile = 256;
+		// grid rows sampled by one job
+		constexpr size_t GridRowsPerJob = 4;
+		// sources the grid is checked around before Auto picks it, and the distances checked
+		constexpr size_t ProbeSources = 16;
+		constexpr float ProbeDistances[] = { 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 32.0f, 64.0f, 128.0f };
+
+		void kernel(const float dx, const float dy, const float strength, float& fx, float& fy) {
+			const float scale = strength / (1.0f + dx * dx + dy * dy);
+			fx = dx * scale;
+			fy = dy * scale;
+		}
+	}
+
+	void ForceField::clear() {
+		mSourceX.clear();
+		mSourceY.clear();
+		mStrength.clear();
+	}
+
+	void ForceField::addSource(const float x, const float y, const float strength) {
+		mSourceX.push_back(x);
+		mSourceY.push_back(y);
+		mStrength.push_back(strength);
+	}
+
+	void ForceField::prepare(const size_t width, const size_t height) {
+		mActive = mEngine;
+		if (mActive == Engine::Auto) {
+			if (sourceCount() <= ExactSourceLimit) {
+				mActive = Engine::Exact;
+			}
+			else {
+				buildGrid(width, height);
+				placeProbes(width, height);
+				mActive = gridError(mProbeX.data(), mProbeY.data(), mProbeX.size()) <= GridErrorBound ? Engine::Grid : Engine::Exact;
+			}
+		}
+		else if (mActive == Engine::Grid) {
+			buildGrid(width, height);
+		}
+	}
+
+	void ForceField::placeProbes(const size_t width, const size_t height) {
+		const float maxX = static_cast<float>(width);
+		const float maxY = static_cast<float>(height);
+		const float directions[4][2] = { { 1.0f, 0.0f }, { 0.0f, 1.0f }, { -0.6f, 0.8f }, { -0.8f, -0.6f } };
+		mProbeX.clear();
+		mProbeY.clear();
+		for (size_t s = 0; s < std::min(ProbeSources, sourceCount()); ++s) {
+			for (const auto distance : ProbeDistances) {
+				for (const auto& direction : directions) {
+					const float x = mSourceX[s] + distance * direction[0];
+					const float y = mSourceY[s] + distance * direction[1];
+					if (x >= 0.0f && x < maxX && y >= 0.0f && y < maxY) {
+						mProbeX.push_back(x);
+						mProbeY.push_back(y);
+					}
+				}
+			}
+		}
+	}
+
+	float ForceField::gridError(const float* px, const float* py, const size_t count) const {
+		float worst = 0.0f;
+		for (size_t k = 0; k < count; ++k) {
+			float gx = 0.0f;
+			float gy = 0.0f;
+			accumulateGrid(px, py, &gx, &gy, k, k + 1);
+
+			float ex = 0.0f;
+			float ey = 0.0f;
+			float scale = 0.0f;
+			for (size_t s = 0; s < sourceCount(); ++s) {
+				float x, y;
+				kernel(px[k] - mSourceX[s], py[k] - mSourceY[s], mStrength[s], x, y);
+				ex += x;
+				ey += y;
+				scale += std::sqrt(x * x + y * y);
+			}
+			if (scale > 0.0f) {
+				worst = std::max(worst, std::sqrt((gx - ex) * (gx - ex) + (gy - ey) * (gy - ey)) / scale);
+			}
+		}
+		return worst;
+	}
+
+	void ForceField::accumulate(const float* px, const float* py, float* fx, float* fy, const size_t begin, const size_t end, const bool vectorized) const {
+		if (mActive == Engine::Grid) {
+			accumulateGrid(px, py, fx, fy, begin, end);
+		}
+		else if (vectorized) {
+			accumulateExact(px, py, fx, fy, begin, end);
+		}
+		else {
+			accumulateExactScalar(px, py, fx, fy, begin, end);
+		}
+	}
+
+	void ForceField::accumulateExactScalar(const float* px, const float* py, float* fx, float* fy, const size_t begin, const size_t end) const {
+		const auto count = sourceCount();
+		for (size_t k = begin; k < end; ++k) {
+			float ax = fx[k - begin];
+			float ay = fy[k - begin];
+			for (size_t s = 0; s < count; ++s) {
+				const float dx = px[k] - mSourceX[s];
+				const float dy = py[k] - mSourceY[s];
+				const float scale = mStrength[s] / (1.0f + dx * dx + dy * dy);
+				ax = ax + dx * scale;
+				ay = ay + dy * scale;
+			}
+			fx[k - begin] = ax;
+			fy[k - begin] = ay;
+		}
+	}
+
+	void ForceField::accumulateExact(const float* px, const float* py, float* fx, float* fy, const size_t begin, const size_t end) const {
+		const auto count = sourceCount();
+		const auto one = simd::set1(1.0f);
+		for (size_t tile = 0; tile < count; tile += SourceTile) {
+			const auto tileEnd = std::min(count, tile + SourceTile);
+
+			size_t k = begin;
+			for (; k + simd::Width <= end; k += simd::Width) {
+				const auto x = simd::load(px + k);
+				const auto y = simd::load(py + k);
+				auto ax = simd::load(fx + k - begin);
+				auto ay = simd::load(fy + k - begin);
+				for (size_t s = tile; s < tileEnd; ++s) {
+					const auto dx = simd::sub(x, simd::set1(mSourceX[s]));
+					const auto dy = simd::sub(y, simd::set1(mSourceY[s]));
+					const auto scale = simd::div(simd::set1(mStrength[s]), simd::add(simd::add(one, simd::mul(dx, dx)), simd::mul(dy, dy)));
+					ax = simd::add(ax, simd::mul(dx, scale));
+					ay = simd::add(ay, simd::mul(dy, scale));
+				}
+				simd::store(fx + k - begin, ax);
+				simd::store(fy + k - begin, ay);
+			}
+
+			for (; k < end; ++k) {
+				float ax = fx[k - begin];
+				float ay = fy[k - begin];
+				for (size_t s = tile; s < tileEnd; ++s) {
+					const float dx = px[k] - mSourceX[s];
+					const float dy = py[k] - mSourceY[s];
+					const float scale = mStrength[s] / (1.0f + dx * dx + dy * dy);
+					ax = ax + dx * scale;
+					ay = ay + dy * scale;
+				}
+				fx[k - begin] = ax;
+				fy[k - begin] = ay;
+			}
+		}
+	}
+
+	void ForceField::buildGrid(const size_t width, const size_t height) {
+		// one node every GridCellSize pixels, the last row/column covers the far world edge
+		const auto columns = static_cast<size_t>(std::ceil(width / GridCellSize)) + 1;
+		const auto rows = static_cast<size_t>(std::ceil(height / GridCellSize)) + 1;
+		if (columns != mColumns || rows != mRows) {
+			mColumns = columns;
+			mRows = rows;
+			mNodeX.resize(mColumns);
+			mNodeY.resize(mColumns * mRows);
+			for (size_t i = 0; i < mColumns; ++i) {
+				mNodeX[i] = i * GridCellSize;
+			}
+			for (size_t row = 0; row < mRows; ++row) {
+				std::fill_n(mNodeY.begin() + row * mColumns, mColumns, row * GridCellSize);
+			}
+		}
+
+		mGridX.assign(mColumns * mRows, 0.0f);
+		mGridY.assign(mColumns * mRows, 0.0f);
+		JobSystem::instance().parallelFor(mRows, GridRowsPerJob, [&](const size_t first, const size_t last) {
+			for (size_t row = first; row < last; ++row) {
+				const auto offset = row * mColumns;
+				accumulateExact(mNodeX.data(), mNodeY.data() + offset, mGridX.data() + offset, mGridY.data() + offset, 0, mColumns);
+			}
+		});
+		buildNearField();
+	}
+
+	template <typename Visit>
+	void ForceField::forNearCells(const size_t source, Visit&& visit) const {
+		// every cell whose rectangle comes within NearFieldRadius of the source
+		const auto cellColumns = static_cast<long long>(mColumns - 1);
+		const auto cellRows = static_cast<long long>(mRows - 1);
+		const float x = mSourceX[source];
+		const float y = mSourceY[source];
+		const auto firstColumn = std::max(0LL, static_cast<long long>(std::floor((x - NearFieldRadius) / GridCellSize)));
+		const auto lastColumn = std::min(cellColumns - 1, static_cast<long long>(std::floor((x + NearFieldRadius) / GridCellSize)));
+		const auto firstRow = std::max(0LL, static_cast<long long>(std::floor((y - NearFieldRadius) / GridCellSize)));
+		const auto lastRow = std::min(cellRows - 1, static_cast<long long>(std::floor((y + NearFieldRadius) / GridCellSize)));
+		for (auto row = firstRow; row <= lastRow; ++row) {
+			const float dy = std::max({ row * GridCellSize - y, 0.0f, y - (row + 1) * GridCellSize });
+			for (auto column = firstColumn; column <= lastColumn; ++column) {
+				const float dx = std::max({ column * GridCellSize - x, 0.0f, x - (column + 1) * GridCellSize });
+				if (dx * dx + dy * dy <= NearFieldRadius * NearFieldRadius) {
+					visit(static_cast<size_t>(row * cellColumns + column));
+				}
+			}
+		}
+	}
+
+	void ForceField::buildNearField() {
+		const auto cells = (mColumns - 1) * (mRows - 1);
+		mNearStart.assign(cells + 1, 0);
+		for (size_t s = 0; s < sourceCount(); ++s) {
+			forNearCells(s, [this](const size_t cell) { ++mNearStart[cell + 1]; });
+		}
+		for (size_t c = 0; c < cells; ++c) {
+			mNearStart[c + 1] += mNearStart[c];
+		}
+		mNearSources.resize(mNearStart.back());
+		mNearCursor.assign(mNearStart.begin(), mNearStart.end() - 1);
+		for (size_t s = 0; s < sourceCount(); ++s) {
+			forNearCells(s, [this, s](const size_t cell) { mNearSources[mNearCursor[cell]++] = static_cast<unsigned int>(s); });
+		}
+	}
+
+	void ForceField::accumulateGrid(const float* px, const float* py, float* fx, float* fy, const size_t begin, const size_t end) const {
+		constexpr float invCell = 1.0f / GridCellSize;
+		const float maxX = static_cast<float>(mColumns - 1);
+		const float maxY = static_cast<float>(mRows - 1);
+		for (size_t k = begin; k < end; ++k) {
+			const float gx = std::min(std::max(px[k] * invCell, 0.0f), maxX);
+			const float gy = std::min(std::max(py[k] * invCell, 0.0f), maxY);
+			const size_t i = std::min(static_cast<size_t>(gx), mColumns - 2);
+			const size_t j = std::min(static_cast<size_t>(gy), mRows - 2);
+			const float tx = gx - i;
+			const float ty = gy - j;
+
+			const size_t n00 = j * mColumns + i;
+			const size_t n10 = n00 + 1;
+			const size_t n01 = n00 + mColumns;
+			const size_t n11 = n01 + 1;
+
+			const float top = mGridX[n00] + (mGridX[n10] - mGridX[n00]) * tx;
+			const float bottom = mGridX[n01] + (mGridX[n11] - mGridX[n01]) * tx;
+			fx[k - begin] += top + (bottom - top) * ty;
+
+			const float topY = mGridY[n00] + (mGridY[n10] - mGridY[n00]) * tx;
+			const float bottomY = mGridY[n01] + (mGridY[n11] - mGridY[n01]) * tx;
+			fy[k - begin] += topY + (bottomY - topY) * ty;
+
+			// near sources: swap what the grid interpolated for them for the exact force, the kernel
+			// peaks within a pixel and the lattice cannot resolve it
+			const size_t cell = j * (mColumns - 1) + i;
+			const float x0 = i * GridCellSize;
+			const float y0 = j * GridCellSize;
+			for (auto n = mNearStart[cell]; n < mNearStart[cell + 1]; ++n) {
+				const auto s = mNearSources[n];
+				const float sx = mSourceX[s];
+				const float sy = mSourceY[s];
+				const float strength = mStrength[s];
+				float ex, ey, ax, ay, bx, by, cx, cy, dx, dy;
+				kernel(px[k] - sx, py[k] - sy, strength, ex, ey);
+				kernel(x0 - sx, y0 - sy, strength, ax, ay);
+				kernel(x0 + GridCellSize - sx, y0 - sy, strength, bx, by);
+				kernel(x0 - sx, y0 + GridCellSize - sy, strength, cx, cy);
+				kernel(x0 + GridCellSize - sx, y0 + GridCellSize - sy, strength, dx, dy);
+				const float nearTop = ax + (bx - ax) * tx;
+				const float nearBottom = cx + (dx - cx) * tx;
+				const float nearTopY = ay + (by - ay) * tx;
+				const float nearBottomY = cy + (dy - cy) * tx;
+				fx[k - begin] += ex - (nearTop + (nearBottom - nearTop) * ty);
+				fy[k - begin] += ey - (nearTopY + (nearBottomY - nearTopY) * ty);
+			}
+		}
+	}
+
+	const char* forceEngineName(const ForceField::Engine engine) {
+		switch (engine) {
+		case ForceField::Engine::Auto:
+			return "auto";
+		case ForceField::Engine::Exact:
+			return "exact";
+		case ForceField::Engine::Grid:
+			return "grid";
+		}
+		return "unknown";
+	}
+
+	bool parseForceEngine(const char* name, ForceField::Engine& engine) {
+		for (const auto candidate : { ForceField::Engine::Auto, ForceField::Engine::Exact, ForceField::Engine::Grid }) {
+			if (std::strcmp(name, forceEngineName(candidate)) == 0) {
+				engine = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace GameJamAsteroids {
+	// Sum of point sources acting on particles. Every source pushes (strength > 0) or pulls
+	// (strength < 0) with strength * d / (1 + |d|^2), d being the particle offset from the source.
+	class ForceField {
+	public:
+		enum class Engine {
+			Auto,
+			// every source against every particle, sources processed in L1-sized tiles
+			Exact,
+			// field sampled on a coarse grid once per tick, particles interpolate bilinearly; sources
+			// within NearFieldRadius of a particle are added exactly instead
+			Grid
+		};
+
+		// Auto switches from Exact to Grid above this many sources, if the grid is within
+		// GridErrorBound around them
+		static constexpr size_t ExactSourceLimit = 32;
+		static constexpr float GridCellSize = 16.0f;
+		static constexpr float NearFieldRadius = 3.0f * GridCellSize;
+		// Largest grid error allowed, relative to the sum of the magnitudes of every source's
+		// contribution at that point so sources cancelling each other do not inflate it.
+		static constexpr float GridErrorBound = 0.05f;
+
+		void clear();
+		void addSource(const float x, const float y, const float strength);
+		size_t sourceCount() const { return mSourceX.size(); }
+
+		void setEngine(const Engine engine) { mEngine = engine; }
+		Engine engine() const { return mEngine; }
+		// engine picked by the last prepare()
+		Engine activeEngine() const { return mActive; }
+
+		// Call once per tick after the sources are in and before accumulate().
+		void prepare(const size_t width, const size_t height);
+
+		// fx[i - begin], fy[i - begin] += force on particle i, for i in [begin, end).
+		void accumulate(const float* px, const float* py, float* fx, float* fy, const size_t begin, const size_t end, const bool vectorized) const;
+		// Largest error of the grid against the exact sum over the given points, relative as for
+		// GridErrorBound. Needs a grid, i.e. a prepare() that picked or considered Grid.
+		float gridError(const float* px, const float* py, const size_t count) const;
+
+	private:
+		void accumulateExactScalar(const float* px, const float* py, float* fx, float* fy, const size_t begin, const size_t end) const;
+		void accumulateExact(const float* px, const float* py, float* fx, float* fy, const size_t begin, const size_t end) const;
+		void accumulateGrid(const float* px, const float* py, float* fx, float* fy, const size_t begin, const size_t end) const;
+		void buildGrid(const size_t width, const size_t height);
+		void buildNearField();
+		// points around the first sources where the grid is checked before Auto picks it
+		void placeProbes(const size_t width, const size_t height);
+		template <typename Visit>
+		void forNearCells(const size_t source, Visit&& visit) const;
+
+		std::vector<float> mSourceX;
+		std::vector<float> mSourceY;
+		std::vector<float> mStrength;
+
+		Engine mEngine{ Engine::Auto };
+		Engine mActive{ Engine::Exact };
+
+		size_t mColumns{ 0 };
+		size_t mRows{ 0 };
+		std::vector<float> mGridX;
+		std::vector<float> mGridY;
+		std::vector<float> mNodeX;
+		std::vector<float> mNodeY;
+		// sources within NearFieldRadius of each grid cell, cell c owns [mNearStart[c], mNearStart[c + 1])
+		std::vector<unsigned int> mNearStart;
+		std::vector<unsigned int> mNearSources;
+		std::vector<unsigned int> mNearCursor;
+		std::vector<float> mProbeX;
+		std::vector<float> mProbeY;
+	};
+
+	const char* forceEngineName(const ForceField::Engine engine);
+	bool parseForceEngine(const char* name, ForceField::Engine& engine);
+}
@@ -0,0 +1,61 @@
+#include <FrameArena.h>
+
+#include <algorithm>
+
+std::atomic<uint64_t> FrameArena::sFrame{ 0 };
+
+FrameArena& FrameArena::local() {
+	thread_local FrameArena arena;
+	return arena;
+}
+
+void FrameArena::endFrame() {
+	sFrame.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* FrameArena::allocate(const size_t bytes, const size_t alignment) {
+	// the frame is ordered before this thread's next allocation by whatever handed it work
+	const auto frame = sFrame.load(std::memory_order_relaxed);
+	if (frame != mFrame) {
+		mFrame = frame;
+		rewind();
+	}
+
+	const auto address = reinterpret_cast<uintptr_t>(mCursor);
+	const auto aligned = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	if (mCursor == nullptr || aligned + bytes > reinterpret_cast<uintptr_t>(mEnd)) {
+		return allocateBlock(bytes, alignment);
+	}
+	mUsed += aligned + bytes - address;
+	mCursor = reinterpret_cast<std::byte*>(aligned + bytes);
+	return reinterpret_cast<void*>(aligned);
+}
+
+void FrameArena::rewind() {
+	if (mBlocks.size() > 1) {
+		// last frame did not fit, next time it does
+		size_t total = 0;
+		for (const auto& block : mBlocks) {
+			total += block.size;
+		}
+		mBlocks.clear();
+		mBlocks.push_back({ std::unique_ptr<std::byte[]>(new std::byte[total]), total });
+	}
+	mCursor = mBlocks.empty() ? nullptr : mBlocks.front().memory.get();
+	mEnd = mBlocks.empty() ? nullptr : mCursor + mBlocks.front().size;
+	mUsed = 0;
+}
+
+void* FrameArena::allocateBlock(const size_t bytes, const size_t alignment) {
+	const auto previous = mBlocks.empty() ? 0 : mBlocks.back().size;
+	const auto size = std::max({ MinBlockSize, 2 * previous, bytes + alignment });
+	mBlocks.push_back({ std::unique_ptr<std::byte[]>(new std::byte[size]), size });
+
+	auto* memory = mBlocks.back().memory.get();
+	const auto address = reinterpret_cast<uintptr_t>(memory);
+	const auto aligned = (address + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+	mCursor = reinterpret_cast<std::byte*>(aligned + bytes);
+	mEnd = memory + size;
+	mUsed += aligned + bytes - address;
+	return reinterpret_cast<void*>(aligned);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Per-thread bump allocator for buffers that live no longer than one frame. Allocating is a
+// pointer bump and freeing does nothing; endFrame() rewinds every thread's arena at once. An
+// arena that overflowed its block during a frame is replaced by one block big enough for the
+// whole frame, so once the frames settle they allocate nothing from the heap.
+class FrameArena {
+public:
+	static constexpr size_t MinBlockSize = 1 << 16;
+
+	// arena of the calling thread
+	static FrameArena& local();
+	// Rewinds every arena before its next allocation. Call once per frame, when nothing allocated
+	// during the frame is used any more, e.g. after the frame's jobs have been waited for.
+	static void endFrame();
+
+	void* allocate(const size_t bytes, const size_t alignment);
+	// bytes handed out since the last rewind
+	size_t used() const { return mUsed; }
+
+private:
+	struct Block {
+		std::unique_ptr<std::byte[]> memory;
+		size_t size{ 0 };
+	};
+
+	void rewind();
+	void* allocateBlock(const size_t bytes, const size_t alignment);
+
+	static std::atomic<uint64_t> sFrame;
+
+	std::vector<Block> mBlocks;
+	std::byte* mCursor{ nullptr };
+	std::byte* mEnd{ nullptr };
+	size_t mUsed{ 0 };
+	uint64_t mFrame{ 0 };
+};
+
+// STL allocator over the calling thread's FrameArena. Containers using it must be gone by the
+// next FrameArena::endFrame(); they may grow on any thread.
+template <typename T>
+class FrameAllocator {
+public:
+	using value_type = T;
+
+	FrameAllocator() = default;
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>&) {
+	}
+
+	T* allocate(const size_t count) {
+		return static_cast<T*>(FrameArena::local().allocate(count * sizeof(T), alignof(T)));
+	}
+	void deallocate(T*, size_t) {
+	}
+
+	template <typename U>
+	bool operator==(const FrameAllocator<U>&) const { return true; }
+	template <typename U>
+	bool operator!=(const FrameAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
@@ -2,12 +2,159 @@
 //
 
 #include "Renderer.h"
+#include <Environment.h>
+#include <JobSystem.h>
+#include <Profiler.h>
 #include <iostream>
 #include <random>
 #include <cmath>
+#include <cstdint>
 #include <string>
+#include <vector>
 
-int main() {
-    GameJamAsteroids::runGame(2560, 1440);
+static int run(const size_t width, const size_t height, const std::vector<std::string>& args, GameJamAsteroids::HeadlessOptions& options) {
+    if (args.size() > 1 && args[0] == "--render-frame") {
+        options.ticks = args.size() > 2 ? std::stoul(args[2]) : 60;
+        if (args.size() > 3) {
+            options.quadCount = std::stoul(args[3]);
+        }
+        return GameJamAsteroids::renderFrame(width, height, options, args[1]);
+    }
+    if (args.size() > 1 && args[0] == "--replay") {
+        const size_t from = args.size() > 2 ? std::stoul(args[2]) : 0;
+        const size_t to = args.size() > 3 ? std::stoul(args[3]) : SIZE_MAX;
+        return GameJamAsteroids::replayRecording(args[1], from, to);
+    }
+    if (args.size() > 1 && args[0] == "--environments") {
+        GameJamAsteroids::EnvironmentOptions environment;
+        environment.width = width;
+        environment.height = height;
+        environment.shipCount = options.shipCount;
+        environment.quadCount = args.size() > 3 ? std::stoul(args[3]) : 0;
+        environment.seed = options.seed;
+        environment.integrator = options.integrator;
+        return GameJamAsteroids::runEnvironments(std::stoul(args[1]), environment, args.size() > 2 ? std::stoul(args[2]) : 600);
+    }
+    if (args.size() > 2 && args[0] == "--diff-images") {
+        return GameJamAsteroids::compareImages(args[1], args[2], args.size() > 3 ? std::stoi(args[3]) : 0);
+    }
+
+    if (args.size() > 2) {
+        options.quadCount = std::stoul(args[2]);
+    }
+    if (!args.empty() && args[0] == "--headless") {
+        if (args.size() > 1) {
+            options.ticks = std::stoul(args[1]);
+        }
+        GameJamAsteroids::runHeadless(width, height, options);
+        return 0;
+    }
+    if (!args.empty() && args[0] == "--verify-integrator") {
+        options.ticks = args.size() > 1 ? std::stoul(args[1]) : 60;
+        return GameJamAsteroids::verifyIntegrator(width, height, options);
+    }
+    if (!args.empty() && args[0] == "--verify-checkpoint") {
+        options.ticks = args.size() > 1 ? std::stoul(args[1]) : 600;
+        return GameJamAsteroids::verifyCheckpoint(width, height, options);
+    }
+    if (!args.empty() && args[0] == "--verify-allocations") {
+        options.ticks = args.size() > 1 ? std::stoul(args[1]) : 1200;
+        return GameJamAsteroids::verifyAllocations(width, height, options);
+    }
+    if (!args.empty() && args[0] == "--verify-force-field") {
+        options.quadCount = args.size() > 1 ? std::stoul(args[1]) : 20000;
+        return GameJamAsteroids::verifyForceField(width, height, options);
+    }
+    if (!args.empty() && args[0] == "--verify-replay") {
+        options.ticks = args.size() > 1 ? std::stoul(args[1]) : 600;
+        return GameJamAsteroids::verifyReplay(width, height, options);
+    }
+
+    GameJamAsteroids::runGame(width, height, options.resumePath);
     return 0;
 }
+
+int main(int argc, char* argv[]) {
+    size_t width = 2560;
+    size_t height = 1440;
+
+    // GameJamAsteroids [options] [--headless [ticks] [particles]] [--verify-integrator [ticks] [particles]]
+    //                  [--verify-replay [ticks]] [--verify-force-field [particles]]
+    //                  [--verify-allocations [ticks] [particles]] [--verify-checkpoint [ticks] [particles]]
+    //                  [--render-frame file [ticks] [particles]] [--diff-images a b [tolerance]]
+    //                  [--replay file [from [to]]] [--environments worlds [ticks] [particles]]
+    //   --integrator scalar|simd   --force-engine auto|exact|grid   --ships N   --threads N   --seed N
+    //   --size WxH         world and framebuffer size in pixels, 2560x1440 by default
+    //   --profile prefix   writes prefix.csv and prefix.json (Chrome trace) on exit
+    //   --record file      logs the headless run's ship actions for --replay
+    //   --checkpoint file  saves the world at the end of a headless run
+    //   --resume file      starts the game or a headless run from a checkpoint
+    //   --policy-server name   the headless ships are flown by PolicyServer name instead of MarkovPolicy
+    GameJamAsteroids::HeadlessOptions options;
+    std::string profilePath;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--integrator" && hasValue) {
+            if (!GameJamAsteroids::parseIntegrator(argv[++i], options.integrator)) {
+                std::cerr << "unknown integrator " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--force-engine" && hasValue) {
+            if (!GameJamAsteroids::parseForceEngine(argv[++i], options.forceEngine)) {
+                std::cerr << "unknown force engine " << argv[i] << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--ships" && hasValue) {
+            options.shipCount = std::stoul(argv[++i]);
+        }
+        else if (arg == "--profile" && hasValue) {
+            profilePath = argv[++i];
+        }
+        else if (arg == "--record" && hasValue) {
+            options.recordPath = argv[++i];
+        }
+        else if (arg == "--checkpoint" && hasValue) {
+            options.checkpointPath = argv[++i];
+        }
+        else if (arg == "--resume" && hasValue) {
+            options.resumePath = argv[++i];
+        }
+        else if (arg == "--policy-server" && hasValue) {
+            options.policyServer = argv[++i];
+        }
+        else if (arg == "--seed" && hasValue) {
+            options.seed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--size" && hasValue) {
+            const std::string size = argv[++i];
+            const auto x = size.find('x');
+            if (x != std::string::npos) {
+                width = std::stoul(size.substr(0, x));
+                height = std::stoul(size.substr(x + 1));
+            }
+            if (x == std::string::npos || width == 0 || height == 0) {
+                std::cerr << "size must be WxH, not " << size << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--threads" && hasValue) {
+            JobSystem::instance().setThreadCount(std::stoul(argv[++i]));
+        }
+        else {
+            args.push_back(arg);
+        }
+    }
+
+    if (!profilePath.empty()) {
+        Profiler::instance().startRecording();
+    }
+    const int result = run(width, height, args, options);
+    if (!profilePath.empty()) {
+        GameJamAsteroids::writeProfile(profilePath);
+    }
+    return result;
+}
@@ -1,55 +1,208 @@
 #include <GameLoop.h>
-#include <Ship.h>
+#include <AllocationCounter.h>
+#include <Collision.h>
+#include <FixedClock.h>
+#include <FrameArena.h>
+#include <JobSystem.h>
+#include <ParticleLifecycle.h>
+#include <Profiler.h>
+#include <Renderer.h>
+#include <ShipSystem.h>
+#include <Simulation.h>
+#include <Snapshot.h>
+#include <World.h>
 #include <chrono>
+#include <cstdio>
 
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/System/Clock.hpp>
 #include <SFML/Window/Event.hpp>
 
-GameLoop::GameLoop() {
+GameLoop::GameLoop(const size_t maxCatchUpSteps)
+	: mMaxCatchUpSteps{ maxCatchUpSteps } {
 }
 
-int GameLoop::run(sf::RenderWindow& window, std::vector<Ship>& ships) {
-	float tick = 0.0f;
+int GameLoop::run(sf::RenderWindow& window, World& world) {
+	auto& jobs = JobSystem::instance();
+	FixedClock clock(std::chrono::duration_cast<FixedClock::Duration>(std::chrono::duration<double>(1.0 / TickRate)), mMaxCatchUpSteps);
+
+	// previous and current are only read by the renderer, the update job writes next
+	WorldSnapshot snapshots[3];
+	size_t previous = 0;
+	size_t current = 1;
+	size_t next = 2;
+	captureSnapshot(world, 0, snapshots[previous]);
+	captureSnapshot(world, 0, snapshots[current]);
+	SfmlBackend backend(window);
+	ParticleRenderer particles;
+	FleetRenderer fleet;
+
+	auto& profiler = Profiler::instance();
+	char windowTitle[255] = "Birds of Pray";
+
 	auto time = std::chrono::steady_clock::now();
+	auto reportTime = time;
+	auto reportAllocations = GameJamAsteroids::allocationCounts().allocations;
+	size_t reportFrames = 0;
 	while (window.isOpen()) {
-		tick += 0.01f;
-
-		sf::Event event;
-		while (window.pollEvent(event)) {
-			switch (event.type) {
-			case sf::Event::Closed:
-				window.close();
-				break;
-			case sf::Event::KeyPressed:
-				if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)) {
+		const auto frameStart = profiler.now();
+		{
+			ProfileScope scope("events");
+			sf::Event event;
+			while (window.pollEvent(event)) {
+				switch (event.type) {
+				case sf::Event::Closed:
 					window.close();
+					break;
+				case sf::Event::KeyPressed:
+					if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)) {
+						window.close();
+					}
+					break;
 				}
-				for (auto&& ship : ships) {
-					//handleKeyboardEvent(event, ship, window);
-				}
-				break;
 			}
 		}
 
-		window.clear(sf::Color::Black);
+		// update, skipped when the frame is shorter than a step
+		const auto now = std::chrono::steady_clock::now();
+		const auto steps = clock.advance(now - time);
+		time = now;
+		const auto update = [&world, &snapshot = snapshots[next], steps, tick = clock.ticks()] {
+			ProfileScope scope("update");
+			for (size_t i = 0; i < steps; ++i) {
+				step(world, FixedStep);
+			}
+			captureSnapshot(world, tick, snapshot);
+		};
+		JobSystem::Counter updated;
+		if (steps > 0) {
+			// small enough for the job to hold without allocating, waited for below; kept off this
+			// thread's queue so the draw's own waits cannot pick it up and run the step inline
+			jobs.runOnWorker(updated, [&update] { update(); });
+		}
+
+		// draw while the next ticks are simulated
+		{
+			ProfileScope scope("draw");
+			backend.clear(sf::Color::Black);
+			GameJamAsteroids::drawSnapshot(backend, snapshots[previous], snapshots[current], clock.alpha(), SpinRate * static_cast<float>(clock.seconds()), particles, fleet);
+		}
+		{
+			ProfileScope scope("display");
+			backend.display();
+		}
+		{
+			ProfileScope scope("wait");
+			jobs.wait(updated);
+		}
+		if (steps > 0) {
+			const auto retired = previous;
+			previous = current;
+			current = next;
+			next = retired;
+		}
+		profiler.record("frame", frameStart, profiler.now());
+		profiler.collect();
+		++reportFrames;
 
-		//drawQuads(window, ecs, tick);
-		for (auto&& ship : ships) {
-			ship.draw(window);
+		// phase percentiles, how the particles were drawn and heap allocations per frame, once a second
+		if (now - reportTime > std::chrono::seconds(1)) {
+			const auto frame = profiler.percentiles("frame");
+			const auto update = profiler.percentiles("update");
+			const auto draw = profiler.percentiles("draw");
+			const auto display = profiler.percentiles("display");
+			const auto& stats = particles.stats();
+			const auto allocations = GameJamAsteroids::allocationCounts().allocations;
+			std::snprintf(windowTitle, sizeof(windowTitle), "Birds of Pray | ms p50/p95/p99 frame %.1f/%.1f/%.1f update %.1f/%.1f/%.1f draw %.1f/%.1f/%.1f display %.1f/%.1f/%.1f | %zu quads %zu points %zu culled | %.1f allocs/frame",
+				frame.p50, frame.p95, frame.p99, update.p50, update.p95, update.p99, draw.p50, draw.p95, draw.p99, display.p50, display.p95, display.p99,
+				stats.quads, stats.points, stats.culled, static_cast<double>(allocations - reportAllocations) / reportFrames);
+			window.setTitle(windowTitle);
+			reportTime = now;
+			reportAllocations = allocations;
+			reportFrames = 0;
 		}
+		FrameArena::endFrame();
+	}
 
-		window.display();
+	return 0;
+}
 
-		// update
-		auto now = std::chrono::steady_clock::now() - time;
-		//simulation(window, width, height, positions, velocities, ship, now.count() * 0.00001f);
-		for (auto&& ship : ships) {
-			ship.update(now.count() * 0.00001f);
+HeadlessStats GameLoop::runHeadless(World& world, size_t ticks, const float dt) {
+	auto& profiler = Profiler::instance();
+	// allocations are counted over the second half, once the buffers have grown to size
+	const auto warmUp = ticks / 2;
+	uint64_t allocations = 0;
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t tick = 0; tick < ticks; ++tick) {
+		if (tick == warmUp) {
+			allocations = GameJamAsteroids::allocationCounts().allocations;
 		}
+		{
+			ProfileScope scope("tick");
+			step(world, dt);
+		}
+		profiler.collect();
+		FrameArena::endFrame();
+	}
+	const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+	allocations = GameJamAsteroids::allocationCounts().allocations - allocations;
 
-		time = std::chrono::steady_clock::now();
+	HeadlessStats stats;
+	stats.ticks = ticks;
+	stats.wallSeconds = elapsed.count();
+	if (stats.wallSeconds > 0.0) {
+		stats.ticksPerSecond = ticks / stats.wallSeconds;
+		stats.simulatedSecondsPerSecond = ticks * dt / (1.0e9 * TimeScale) / stats.wallSeconds;
 	}
+	if (ticks > warmUp) {
+		stats.allocationsPerTick = static_cast<double>(allocations) / (ticks - warmUp);
+	}
+	return stats;
+}
 
-	return 0;
+void GameLoop::updateShips(World& world, const float dt) {
+	const auto count = GameJamAsteroids::shipCount(world.ecs);
+	world.shipActions.resize(count);
+	if (world.policy) {
+		world.policy->resize(count);
+		const auto observations = GameJamAsteroids::observeShips(world.ecs, world.width, world.height);
+		world.policy->prepare(observations);
+		JobSystem::instance().parallelFor(count, ShipsPerJob, [&](const size_t begin, const size_t end) {
+			world.policy->act(observations, world.shipActions, begin, end);
+		});
+	}
+	GameJamAsteroids::integrateShips(world.width, world.height, world.ecs, world.shipActions, dt, world.integrator);
+}
+
+void GameLoop::step(World& world, const float dt) {
+	{
+		ProfileScope scope("ships");
+		updateShips(world, dt);
+	}
+
+	auto& positions = world.ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
+	auto& velocities = world.ecs.data<ecs::EntityType::Square, ecs::ComponentType::Velocity>();
+	if (!positions.empty()) {
+		{
+			ProfileScope scope("forceField");
+			GameJamAsteroids::buildForceField(world.field, world.wells, world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>(), world.width, world.height);
+		}
+		ProfileScope scope("particles");
+		GameJamAsteroids::simulation(world.width, world.height, positions, velocities, world.field, dt, world.integrator);
+	}
+	{
+		ProfileScope scope("lifecycle");
+		GameJamAsteroids::updateParticleLifecycle(world);
+	}
+
+	{
+		ProfileScope scope("collisions");
+		GameJamAsteroids::resolveCollisions(world);
+	}
+	++world.tick;
+
+	if (world.recorder && !world.recorder->record(world)) {
+		std::fprintf(stderr, "action recording stopped at tick %zu\n", world.recorder->ticks());
+		world.recorder.reset();
+	}
 }
@@ -3,11 +3,41 @@
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <vector>
 
-class Ship;
+struct World;
+
+struct HeadlessStats {
+	size_t ticks{ 0 };
+	double wallSeconds{ 0.0 };
+	double ticksPerSecond{ 0.0 };
+	double simulatedSecondsPerSecond{ 0.0 };
+	// heap allocations per tick over the second half of the run
+	double allocationsPerTick{ 0.0 };
+};
 
 class GameLoop {
 public:
-	GameLoop();
-	int run(sf::RenderWindow& window, std::vector<Ship>& ships);
+	// simulation time units per nanosecond of wall-clock time
+	static constexpr float TimeScale = 0.00001f;
+	static constexpr float TickRate = 60.0f;
+	static constexpr float FixedStep = 1.0e9f / TickRate * TimeScale;
+	// steps simulated in one frame after a stall before the rest of the backlog is dropped
+	static constexpr size_t DefaultMaxCatchUpSteps = 5;
+	// particle spin in radians per simulated second, what 0.01 per frame gave at 60 Hz
+	static constexpr float SpinRate = 0.6f;
+	// ships one policy job decides for
+	static constexpr size_t ShipsPerJob = 1024;
+
+	explicit GameLoop(const size_t maxCatchUpSteps = DefaultMaxCatchUpSteps);
+	// Simulates the fixed steps due this frame on the job system while the last two ticks are
+	// drawn, interpolated, from snapshots.
+	int run(sf::RenderWindow& window, World& world);
+	HeadlessStats runHeadless(World& world, size_t ticks, const float dt = FixedStep);
+
+	static void step(World& world, const float dt);
+	// Asks the world's policy for every ship's actions, then integrates the whole fleet.
+	static void updateShips(World& world, const float dt);
+
+private:
+	size_t mMaxCatchUpSteps;
 };
 
@@ -0,0 +1,192 @@
+#include <JobSystem.h>
+
+namespace {
+	// queue owned by the current thread, 0 is shared by every thread that is not a worker
+	thread_local const JobSystem* tOwner = nullptr;
+	thread_local size_t tQueue = 0;
+}
+
+JobSystem& JobSystem::instance() {
+	static JobSystem jobs;
+	return jobs;
+}
+
+JobSystem::JobSystem(const size_t threads) {
+	start(threads);
+}
+
+JobSystem::~JobSystem() {
+	stop();
+}
+
+void JobSystem::setThreadCount(const size_t threads) {
+	stop();
+	start(threads);
+}
+
+void JobSystem::start(size_t threads) {
+	if (threads == 0) {
+		threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+	}
+
+	mQueues.clear();
+	for (size_t i = 0; i < threads; ++i) {
+		mQueues.push_back(std::make_unique<Queue>());
+	}
+	for (size_t i = 1; i < threads; ++i) {
+		mWorkers.emplace_back([this, i] { workerLoop(i); });
+	}
+}
+
+void JobSystem::stop() {
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+		mStopping = true;
+	}
+	mWake.notify_all();
+	for (auto& worker : mWorkers) {
+		worker.join();
+	}
+	mWorkers.clear();
+	mStopping = false;
+}
+
+void JobSystem::run(Counter& counter, Job job) {
+	counter.mPending.fetch_add(1, std::memory_order_relaxed);
+	push({ std::move(job), &counter });
+}
+
+void JobSystem::runOnWorker(Counter& counter, Job job) {
+	if (mWorkers.empty()) {
+		run(counter, std::move(job));
+		return;
+	}
+
+	counter.mPending.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(mWorkerQueue.mutex);
+		mWorkerQueue.pushBack({ std::move(job), &counter });
+	}
+	mQueued.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+	mWake.notify_one();
+}
+
+void JobSystem::wait(Counter& counter) {
+	while (!counter.done()) {
+		Task task;
+		if (tryPop(task)) {
+			execute(task);
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::workerLoop(const size_t index) {
+	tOwner = this;
+	tQueue = index;
+	for (;;) {
+		Task task;
+		if (tryPop(task)) {
+			execute(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(mSleepMutex);
+		mWake.wait(lock, [this] { return mStopping || mQueued.load() > 0; });
+		if (mStopping && mQueued.load() == 0) {
+			return;
+		}
+	}
+}
+
+void JobSystem::push(Task task) {
+	{
+		auto& queue = *mQueues[queueIndex()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.pushBack(std::move(task));
+	}
+	mQueued.fetch_add(1);
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+	mWake.notify_one();
+}
+
+bool JobSystem::tryPop(Task& task) {
+	const auto own = queueIndex();
+	{
+		auto& queue = *mQueues[own];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.size > 0) {
+			task = queue.popBack();
+			mQueued.fetch_sub(1);
+			return true;
+		}
+	}
+
+	if (tOwner == this) {
+		std::lock_guard<std::mutex> lock(mWorkerQueue.mutex);
+		if (mWorkerQueue.size > 0) {
+			task = mWorkerQueue.popFront();
+			mQueued.fetch_sub(1);
+			return true;
+		}
+	}
+
+	for (size_t i = 1; i < mQueues.size(); ++i) {
+		auto& queue = *mQueues[(own + i) % mQueues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.size > 0) {
+			task = queue.popFront();
+			mQueued.fetch_sub(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::execute(Task& task) {
+	task.job();
+	// the waiter may return and destroy the counter as soon as it reaches zero, so it is not
+	// touched after this
+	task.counter->mPending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::Queue::pushBack(Task task) {
+	if (size == tasks.size()) {
+		std::vector<Task> grown(std::max<size_t>(64, 2 * tasks.size()));
+		for (size_t i = 0; i < size; ++i) {
+			grown[i] = std::move(tasks[(first + i) % tasks.size()]);
+		}
+		tasks.swap(grown);
+		first = 0;
+	}
+	tasks[(first + size) % tasks.size()] = std::move(task);
+	++size;
+}
+
+JobSystem::Task JobSystem::Queue::popBack() {
+	--size;
+	auto& slot = tasks[(first + size) % tasks.size()];
+	auto task = std::move(slot);
+	slot = {};
+	return task;
+}
+
+JobSystem::Task JobSystem::Queue::popFront() {
+	auto& slot = tasks[first];
+	auto task = std::move(slot);
+	slot = {};
+	first = (first + 1) % tasks.size();
+	--size;
+	return task;
+}
+
+size_t JobSystem::queueIndex() const {
+	return tOwner == this ? tQueue : 0;
+}
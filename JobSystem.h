@@ -0,0 +1,114 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it pops its own jobs newest first and
+// steals the oldest jobs of the others when it runs dry. Threads that wait on a Counter run
+// queued jobs instead of blocking, so nested parallelFor calls do not deadlock.
+class JobSystem {
+public:
+	using Job = std::function<void()>;
+
+	// Number of unfinished jobs in a group.
+	class Counter {
+	public:
+		bool done() const { return mPending.load(std::memory_order_acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		std::atomic<size_t> mPending{ 0 };
+	};
+
+	static JobSystem& instance();
+
+	// threads counts the calling thread too, 0 picks one per hardware thread
+	explicit JobSystem(const size_t threads = 0);
+	~JobSystem();
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	size_t threadCount() const { return mWorkers.size() + 1; }
+	// Restarts the workers; nothing may be queued or running.
+	void setThreadCount(const size_t threads);
+
+	void run(Counter& counter, Job job);
+	// Like run, but only a worker may pick the job up, so the caller's waits never run it
+	// inline. Falls back to run when there are no workers.
+	void runOnWorker(Counter& counter, Job job);
+	// Runs queued jobs on the calling thread until counter is done.
+	void wait(Counter& counter);
+
+	// body(begin, end) over [0, count) in chunks of at most grain elements, the calling thread
+	// takes the first chunk.
+	template <typename F>
+	void parallelFor(const size_t count, const size_t grain, F&& body);
+
+private:
+	struct Task {
+		Job job;
+		Counter* counter{ nullptr };
+	};
+
+	// Ring of tasks that keeps its storage, queueing only allocates while it grows to the deepest
+	// it has been.
+	struct Queue {
+		std::mutex mutex;
+		std::vector<Task> tasks;
+		size_t first{ 0 };
+		size_t size{ 0 };
+
+		void pushBack(Task task);
+		Task popBack();
+		Task popFront();
+	};
+
+	void start(const size_t threads);
+	void stop();
+	void workerLoop(const size_t index);
+	void push(Task task);
+	bool tryPop(Task& task);
+	void execute(Task& task);
+	size_t queueIndex() const;
+
+	std::vector<std::unique_ptr<Queue>> mQueues;
+	// jobs from runOnWorker, popped by workers only
+	Queue mWorkerQueue;
+	std::vector<std::thread> mWorkers;
+	std::atomic<size_t> mQueued{ 0 };
+	std::mutex mSleepMutex;
+	std::condition_variable mWake;
+	bool mStopping{ false };
+};
+
+template <typename F>
+inline void JobSystem::parallelFor(const size_t count, const size_t grain, F&& body) {
+	const size_t chunkSize = std::max<size_t>(1, grain);
+	const size_t chunks = (count + chunkSize - 1) / chunkSize;
+	if (chunks <= 1 || mWorkers.empty()) {
+		for (size_t begin = 0; begin < count; begin += chunkSize) {
+			body(begin, std::min(count, begin + chunkSize));
+		}
+		return;
+	}
+
+	// the queued jobs capture two words, which std::function stores without allocating
+	const auto runChunk = [&body, chunkSize, count](const size_t chunk) {
+		const size_t begin = chunk * chunkSize;
+		body(begin, std::min(count, begin + chunkSize));
+	};
+	Counter counter;
+	for (size_t chunk = 1; chunk < chunks; ++chunk) {
+		run(counter, [&runChunk, chunk] { runChunk(chunk); });
+	}
+	runChunk(0);
+	wait(counter);
+}
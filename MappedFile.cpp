@@ -0,0 +1,70 @@
+#include <MappedFile.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::unique_ptr<MappedFile> MappedFile::open(const std::string& path) {
+	std::unique_ptr<MappedFile> file(new MappedFile());
+#if defined(_WIN32)
+	file->mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file->mFile == INVALID_HANDLE_VALUE) {
+		file->mFile = nullptr;
+		return nullptr;
+	}
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file->mFile, &size) || size.QuadPart <= 0) {
+		return nullptr;
+	}
+	file->mSize = static_cast<size_t>(size.QuadPart);
+	file->mMapping = CreateFileMappingA(file->mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (file->mMapping == nullptr) {
+		return nullptr;
+	}
+	file->mData = static_cast<const uint8_t*>(MapViewOfFile(file->mMapping, FILE_MAP_READ, 0, 0, 0));
+#else
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return nullptr;
+	}
+	struct stat status {};
+	if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+		close(fd);
+		return nullptr;
+	}
+	file->mSize = static_cast<size_t>(status.st_size);
+	void* data = mmap(nullptr, file->mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return nullptr;
+	}
+	// the columns are read front to back once
+	madvise(data, file->mSize, MADV_SEQUENTIAL);
+	file->mData = static_cast<const uint8_t*>(data);
+#endif
+	return file->mData != nullptr ? std::move(file) : nullptr;
+}
+
+MappedFile::~MappedFile() {
+#if defined(_WIN32)
+	if (mData != nullptr) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping != nullptr) {
+		CloseHandle(mMapping);
+	}
+	if (mFile != nullptr) {
+		CloseHandle(mFile);
+	}
+#else
+	if (mData != nullptr) {
+		munmap(const_cast<uint8_t*>(mData), mSize);
+	}
+#endif
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// A whole file mapped read-only into memory: mmap on POSIX, a file mapping on Windows. Pages are
+// read on first touch, so opening is constant time whatever the file size.
+class MappedFile {
+public:
+	// nullptr when the file cannot be opened or is empty
+	static std::unique_ptr<MappedFile> open(const std::string& path);
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const uint8_t* data() const { return mData; }
+	size_t size() const { return mSize; }
+
+private:
+	MappedFile() = default;
+
+	const uint8_t* mData{ nullptr };
+	size_t mSize{ 0 };
+#if defined(_WIN32)
+	void* mFile{ nullptr };
+	void* mMapping{ nullptr };
+#endif
+};
@@ -0,0 +1,143 @@
+#include <ParticleLifecycle.h>
+#include <Collision.h>
+#include <ECS.h>
+#include <Random.h>
+#include <ShipSystem.h>
+#include <World.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace GameJamAsteroids {
+	namespace {
+		// exhaust leaves just behind the hull, this fast against the ship
+		constexpr float ExhaustOffset = 1.25f * ShipRadius;
+		constexpr float ExhaustSpeed = 0.05f;
+		constexpr float ExhaustSpread = 0.02f;
+		constexpr float WellSpread = 0.1f;
+		constexpr float ParticleSide = 1.5f;
+		constexpr float TwoPi = 6.2831853f;
+
+		float wrap(const float value, const float size) {
+			const float wrapped = std::fmod(value, size);
+			return wrapped < 0.0f ? wrapped + size : wrapped;
+		}
+	}
+
+	size_t retireParticles(ECS& ecs) {
+		auto& ttls = ecs.data<ecs::EntityType::Square, ecs::ComponentType::TimeToLive>();
+		const auto& entities = ecs.entities<ecs::EntityType::Square>();
+		size_t retired = 0;
+		// from the back, so the particle swapped into a hole has already been aged
+		for (size_t n = ttls.size(); n-- > 0;) {
+			if (ttls[n] > 1) {
+				--ttls[n];
+				continue;
+			}
+			ecs.destroyEntity(entities[n]);
+			++retired;
+		}
+		return retired;
+	}
+
+	void collectEmitters(const ECS& ecs, const std::vector<sf::Vector3f>& wells, const size_t width, const size_t height, std::vector<Emitter>& emitters) {
+		const auto w = static_cast<float>(width);
+		const auto h = static_cast<float>(height);
+		const auto& positions = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+		const auto& velocities = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Velocity>();
+		const auto& headings = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Heading>();
+		const auto& colors = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Color>();
+
+		emitters.clear();
+		for (size_t i = 0; i < positions.size(); ++i) {
+			const float backX = -std::cos(headings[i]);
+			const float backY = -std::sin(headings[i]);
+			emitters.push_back({
+				{ wrap(positions.x[i] + ExhaustOffset * backX, w), wrap(positions.y[i] + ExhaustOffset * backY, h) },
+				{ velocities.x[i] + ExhaustSpeed * backX, velocities.y[i] + ExhaustSpeed * backY },
+				ExhaustSpread,
+				colors[i] });
+		}
+		for (const auto& well : wells) {
+			emitters.push_back({ { well.x, well.y }, { 0.0f, 0.0f }, WellSpread, { 0, 128, 0 } });
+		}
+	}
+
+	ecs::EntityRange emitParticles(ECS& ecs, const std::vector<Emitter>& emitters, const size_t count, const uint64_t seed, const size_t tick) {
+		if (count == 0 || emitters.empty()) {
+			const auto end = static_cast<unsigned int>(ecs.entities<ecs::EntityType::Square>().size());
+			return { ecs::EntityType::Square, end, end };
+		}
+
+		// set(i, a, b) gets two of the four values drawn for particle first + i
+		const Philox random(seed);
+		const auto now = static_cast<uint32_t>(tick);
+		auto forEach = [&random, now](const size_t first, const size_t n, const ecs::ComponentType component, auto&& set) {
+			constexpr size_t Batch = 256;
+			uint32_t draws[4][Batch];
+			for (size_t begin = 0; begin < n; begin += Batch) {
+				const auto batch = std::min(Batch, n - begin);
+				random.generate(static_cast<uint32_t>(first + begin), batch, RandomStream::Respawn, now, static_cast<uint32_t>(component), draws[0], draws[1], draws[2], draws[3]);
+				for (size_t k = 0; k < batch; ++k) {
+					set(begin + k, Philox::uniform(draws[0][k]), draws[1][k]);
+				}
+			}
+		};
+		auto emitterOf = [&emitters, now](const size_t k) -> const Emitter& {
+			return emitters[(k + now) % emitters.size()];
+		};
+
+		return ecs.createEntities<ecs::EntityType::Square>(count,
+			ecs::column<ecs::ComponentType::Color>([&](ecs::Color* out, size_t first, size_t n) {
+				for (size_t i = 0; i < n; ++i) {
+					out[i] = emitterOf(first + i).color;
+				}
+			}),
+			ecs::column<ecs::ComponentType::Position>([&](ecs::Vec2Pointer out, size_t first, size_t n) {
+				for (size_t i = 0; i < n; ++i) {
+					const auto& position = emitterOf(first + i).position;
+					out.x[i] = position.x;
+					out.y[i] = position.y;
+				}
+			}),
+			ecs::column<ecs::ComponentType::Velocity>([&](ecs::Vec2Pointer out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::Velocity, [&, out, first](const size_t i, const float u, const uint32_t v) {
+					const auto& emitter = emitterOf(first + i);
+					const float angle = TwoPi * u;
+					const float speed = emitter.spread * Philox::uniform(v);
+					out.x[i] = emitter.velocity.x + speed * std::cos(angle);
+					out.y[i] = emitter.velocity.y + speed * std::sin(angle);
+				});
+			}),
+			ecs::column<ecs::ComponentType::Size>([&](ecs::Size* out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::Size, [out](const size_t i, const float u, const uint32_t v) {
+					out[i].x = ParticleSide + u * ParticleSide;
+					out[i].y = ParticleSide + Philox::uniform(v) * ParticleSide;
+				});
+			}),
+			ecs::column<ecs::ComponentType::AngularVelocity>([&](ecs::AngularVelocity* out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::AngularVelocity, [out](const size_t i, const float u, uint32_t) {
+					out[i] = 1.0f + 0.1f * u;
+				});
+			}),
+			ecs::column<ecs::ComponentType::TimeToLive>([&](ecs::TimeToLive* out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::TimeToLive, [out](const size_t i, float, const uint32_t v) {
+					out[i] = static_cast<ecs::TimeToLive>(500 + 10 * Philox::below(v, 101));
+				});
+			}));
+	}
+
+	void updateParticleLifecycle(World& world) {
+		auto& lifecycle = world.particles;
+		// sized from the first tick on, long before the first particle expires
+		lifecycle.emitters.reserve(shipCount(world.ecs) + world.wells.size());
+		lifecycle.retired = retireParticles(world.ecs);
+		lifecycle.spawned = 0;
+
+		const auto live = world.ecs.entities<ecs::EntityType::Square>().size();
+		if (live < lifecycle.capacity) {
+			collectEmitters(world.ecs, world.wells, world.width, world.height, lifecycle.emitters);
+			lifecycle.spawned = emitParticles(world.ecs, lifecycle.emitters, lifecycle.capacity - live, world.seed, world.tick).size();
+		}
+	}
+}
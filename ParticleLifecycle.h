@@ -0,0 +1,43 @@
+#pragma once
+
+#include <EcsTypes.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ECS;
+struct World;
+
+namespace GameJamAsteroids {
+	// Source of new particles: they start at position moving with velocity, plus up to spread in
+	// a random direction.
+	struct Emitter {
+		ecs::Vec2f position;
+		ecs::Vec2f velocity;
+		float spread{ 0.0f };
+		ecs::Color color;
+	};
+
+	// Every particle lives for its TimeToLive in ticks. Expired particles are destroyed, so the
+	// particle columns only ever hold live ones, and the emitters replace them in one batch that
+	// brings the population back to capacity.
+	struct ParticleLifecycle {
+		size_t capacity{ 0 };
+		// ship exhausts, then gravity wells, rebuilt when particles are spawned
+		std::vector<Emitter> emitters;
+		// what the last update did
+		size_t retired{ 0 };
+		size_t spawned{ 0 };
+	};
+
+	// Ages every particle by a tick and destroys those whose time is up; returns how many went.
+	size_t retireParticles(ECS& ecs);
+	// An exhaust behind every ship, then a source at every well.
+	void collectEmitters(const ECS& ecs, const std::vector<sf::Vector3f>& wells, const size_t width, const size_t height, std::vector<Emitter>& emitters);
+	// Spawns count particles in one batch. Particle k comes from emitter (k + tick) % emitters.size()
+	// and draws its state from Philox at (k, tick), whatever thread fills it in.
+	ecs::EntityRange emitParticles(ECS& ecs, const std::vector<Emitter>& emitters, const size_t count, const uint64_t seed, const size_t tick);
+	// Retires the expired particles and tops the population back up to capacity, once per tick
+	// after the particles moved.
+	void updateParticleLifecycle(World& world);
+}
@@ -0,0 +1,107 @@
+#include <ParticleRenderer.h>
+#include <JobSystem.h>
+#include <Snapshot.h>
+
+#include <algorithm>
+#include <cmath>
+
+void ParticleRenderer::setView(const sf::View& view, const sf::Vector2u pixels) {
+	const auto size = view.getSize();
+	const auto center = view.getCenter();
+	mCull = true;
+	mVisible = { center.x - 0.5f * size.x, center.y - 0.5f * size.y, size.x, size.y };
+	mPixelsPerUnit = size.x > 0.0f ? pixels.x / size.x : 1.0f;
+}
+
+void ParticleRenderer::update(const ecs::Vec2Column* previous, const std::vector<ecs::EntityHandle>* previousHandles, const std::vector<ecs::EntityHandle>& handles, const ecs::Vec2Column& positions, const std::vector<ecs::Size>& sizes, const std::vector<ecs::Color>& colors, const std::vector<ecs::AngularVelocity>& angular, const float alpha, const sf::Vector2f bounds, const float rad) {
+	// retired and spawned particles move others to new indices, only matching handles blend
+	const bool interpolate = previous != nullptr && previousHandles != nullptr && previousHandles->size() == previous->size() && handles.size() == positions.size();
+	const size_t previousCount = interpolate ? previous->size() : 0;
+	// below this extent in world units a particle is less than the threshold on screen
+	const float pointExtent = 0.5f * mPointThreshold / mPixelsPerUnit;
+	const float left = mVisible.left;
+	const float top = mVisible.top;
+	const float right = mVisible.left + mVisible.width;
+	const float bottom = mVisible.top + mVisible.height;
+
+	const size_t count = positions.size();
+	const size_t chunks = (count + ParticlesPerJob - 1) / ParticlesPerJob;
+	mQuads.resize(4 * count);
+	mPoints.resize(count);
+	mChunkQuads.assign(chunks, 0);
+	mChunkPoints.assign(chunks, 0);
+
+	// every chunk writes into its own range, the ranges are packed afterwards
+	JobSystem::instance().parallelFor(count, ParticlesPerJob, [&](const size_t begin, const size_t end) {
+		sf::Vertex* quads = mQuads.data() + 4 * begin;
+		sf::Vertex* points = mPoints.data() + begin;
+		size_t quadCount = 0;
+		size_t pointCount = 0;
+		for (size_t n = begin; n < end; ++n) {
+			ecs::Vec2f pos = positions[n];
+			if (n < previousCount && (*previousHandles)[n] == handles[n]) {
+				const ecs::Vec2f from = (*previous)[n];
+				pos.x = lerpWrapped(from.x, pos.x, alpha, bounds.x);
+				pos.y = lerpWrapped(from.y, pos.y, alpha, bounds.y);
+			}
+
+			const auto size = sizes[n];
+			const float extent = std::max(size.x, size.y);
+			// a rotated quad never leaves the circle through its corners
+			const float reach = 1.4142136f * extent;
+			if (mCull && (pos.x + reach < left || pos.x - reach > right || pos.y + reach < top || pos.y - reach > bottom)) {
+				continue;
+			}
+
+			const auto& color = colors[n];
+			const sf::Color sfColor = { color.r, color.g, color.b, 64 };
+			if (extent < pointExtent) {
+				points[pointCount++] = sf::Vertex({ pos.x, pos.y }, sfColor);
+				continue;
+			}
+
+			// one sin/cos per quad, the corners are (+-size.x, +-size.y) rotated by it
+			const float angle = rad * angular[n];
+			const float s = std::sin(angle);
+			const float c = std::cos(angle);
+			const float xc = size.x * c;
+			const float xs = size.x * s;
+			const float yc = size.y * c;
+			const float ys = size.y * s;
+
+			sf::Vertex* out = quads + 4 * quadCount++;
+			out[0] = sf::Vertex({ pos.x - xc + ys, pos.y - xs - yc }, sfColor);
+			out[1] = sf::Vertex({ pos.x + xc + ys, pos.y + xs - yc }, sfColor);
+			out[2] = sf::Vertex({ pos.x + xc - ys, pos.y + xs + yc }, sfColor);
+			out[3] = sf::Vertex({ pos.x - xc - ys, pos.y - xs + yc }, sfColor);
+		}
+		mChunkQuads[begin / ParticlesPerJob] = quadCount;
+		mChunkPoints[begin / ParticlesPerJob] = pointCount;
+	});
+
+	// close the gaps left by culled particles and by the other path
+	mQuadVertexCount = 0;
+	mPointCount = 0;
+	for (size_t chunk = 0; chunk < chunks; ++chunk) {
+		const size_t begin = chunk * ParticlesPerJob;
+		if (mQuadVertexCount != 4 * begin) {
+			const auto quads = mQuads.begin() + 4 * begin;
+			std::copy(quads, quads + 4 * mChunkQuads[chunk], mQuads.begin() + mQuadVertexCount);
+		}
+		if (mPointCount != begin) {
+			const auto points = mPoints.begin() + begin;
+			std::copy(points, points + mChunkPoints[chunk], mPoints.begin() + mPointCount);
+		}
+		mQuadVertexCount += 4 * mChunkQuads[chunk];
+		mPointCount += mChunkPoints[chunk];
+	}
+
+	mStats.quads = mQuadVertexCount / 4;
+	mStats.points = mPointCount;
+	mStats.culled = count - mStats.quads - mStats.points;
+}
+
+void ParticleRenderer::draw(RenderBackend& backend) const {
+	backend.draw(mQuads.data(), mQuadVertexCount, sf::Quads);
+	backend.draw(mPoints.data(), mPointCount, sf::Points);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <EcsColumns.h>
+#include <EcsTypes.h>
+#include <RenderBackend.h>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <vector>
+
+// Rotated quad per particle. Particles outside the view are culled and those smaller than the
+// point threshold on screen are drawn as single points. Vertices are laid out in parallel chunks
+// into storage kept between frames.
+class ParticleRenderer {
+public:
+	// particles laid out by one job
+	static constexpr size_t ParticlesPerJob = 8192;
+	static constexpr float DefaultPointThreshold = 2.0f;
+
+	// what happened to the particles in the last update()
+	struct Stats {
+		size_t culled{ 0 };
+		size_t points{ 0 };
+		size_t quads{ 0 };
+	};
+
+	// Area to cull against and its size in pixels; without a view nothing is culled.
+	void setView(const sf::View& view, const sf::Vector2u pixels);
+	// particles whose larger side is below this many pixels become points
+	void setPointThreshold(const float pixels) { mPointThreshold = pixels; }
+
+	// Given previous positions and handles, every particle whose handle is where it was is placed
+	// alpha of the way from there to its current position. rad * angular velocity is the rotation
+	// of each quad.
+	void update(const ecs::Vec2Column* previous, const std::vector<ecs::EntityHandle>* previousHandles, const std::vector<ecs::EntityHandle>& handles, const ecs::Vec2Column& positions, const std::vector<ecs::Size>& sizes, const std::vector<ecs::Color>& colors, const std::vector<ecs::AngularVelocity>& angular, const float alpha, const sf::Vector2f bounds, const float rad);
+	void draw(RenderBackend& backend) const;
+
+	const Stats& stats() const { return mStats; }
+
+private:
+	std::vector<sf::Vertex> mQuads;
+	std::vector<sf::Vertex> mPoints;
+	size_t mQuadVertexCount{ 0 };
+	size_t mPointCount{ 0 };
+	std::vector<size_t> mChunkQuads;
+	std::vector<size_t> mChunkPoints;
+
+	bool mCull{ false };
+	sf::FloatRect mVisible;
+	float mPixelsPerUnit{ 1.0f };
+	float mPointThreshold{ DefaultPointThreshold };
+	Stats mStats;
+};
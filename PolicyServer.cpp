@@ -0,0 +1,104 @@
+// Stand-in policy server for --policy-server: maps the segment the game creates, answers every
+// request and exits when the game does. Ships turn back towards the middle once they leave its
+// inner half and throttle towards the fleet's mean speed.
+//
+// PolicyServer [name]
+
+#include <RemotePolicy.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace GameJamAsteroids;
+
+static void decide(const PolicyChannel& channel) {
+	const auto& header = *channel.header;
+	const auto count = header.shipCount;
+	float meanSpeed = 0.0f;
+	for (uint32_t k = 0; k < count; ++k) {
+		meanSpeed += channel.speed[k];
+	}
+	meanSpeed = count > 0 ? meanSpeed / count : 0.0f;
+
+	const float cx = header.width * 0.5f;
+	const float cy = header.height * 0.5f;
+	for (uint32_t k = 0; k < count; ++k) {
+		const float dx = cx - channel.x[k];
+		const float dy = cy - channel.y[k];
+		auto steering = SteeringState::Continue;
+		if (std::abs(dx) > header.width * 0.25f || std::abs(dy) > header.height * 0.25f) {
+			// signed angle from the heading to the middle, in (-pi, pi]
+			const float cross = std::cos(channel.heading[k]) * dy - std::sin(channel.heading[k]) * dx;
+			const float dot = std::cos(channel.heading[k]) * dx + std::sin(channel.heading[k]) * dy;
+			const float angle = std::atan2(cross, dot);
+			if (std::abs(angle) > 0.1f) {
+				steering = angle > 0.0f ? SteeringState::Right : SteeringState::Left;
+			}
+		}
+		auto speed = SpeedState::Continue;
+		if (channel.speed[k] < meanSpeed * 0.9f) {
+			speed = SpeedState::Increase;
+		}
+		else if (channel.speed[k] > meanSpeed * 1.1f) {
+			speed = SpeedState::Decrease;
+		}
+		channel.steering[k] = static_cast<uint8_t>(steering);
+		channel.throttle[k] = static_cast<uint8_t>(speed);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	const std::string name = argc > 1 ? argv[1] : "GameJamAsteroids-policy";
+
+	std::cout << "waiting for " << name << std::endl;
+	// the segment can show up before the game has written its header, which it then publishes by
+	// storing the magic
+	std::unique_ptr<SharedMemory> memory;
+	PolicyChannelHeader* header = nullptr;
+	uint32_t magic = 0;
+	for (;;) {
+		if (!memory) {
+			memory = SharedMemory::open(name);
+		}
+		if (memory) {
+			if (memory->size() < sizeof(PolicyChannelHeader)) {
+				std::cerr << name << " is too small for a policy channel" << std::endl;
+				return 2;
+			}
+			header = static_cast<PolicyChannelHeader*>(memory->data());
+			magic = header->magic.load(std::memory_order_acquire);
+			if (magic != 0) {
+				break;
+			}
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	if (magic != PolicyChannel::Magic || header->version != PolicyChannel::Version || memory->size() < PolicyChannel::bytes(header->capacity)) {
+		std::cerr << name << " is not a policy channel of version " << PolicyChannel::Version << std::endl;
+		return 2;
+	}
+	const auto channel = PolicyChannel::map(memory->data(), header->capacity);
+	SharedSignal request(PolicyChannel::requestSignal(name), header->request);
+	SharedSignal response(PolicyChannel::responseSignal(name), header->response);
+	std::cout << "serving up to " << header->capacity << " ships" << std::endl;
+
+	size_t answered = 0;
+	auto seen = response.value();
+	while (header->closed.load(std::memory_order_acquire) == 0) {
+		if (!request.wait(seen, std::chrono::seconds(1))) {
+			continue;
+		}
+		seen = request.value();
+		if (header->closed.load(std::memory_order_acquire) != 0) {
+			break;
+		}
+		decide(channel);
+		response.notify(seen);
+		++answered;
+	}
+	std::cout << "answered " << answered << " ticks" << std::endl;
+	return 0;
+}
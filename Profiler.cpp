@@ -0,0 +1,128 @@
+#include <Profiler.h>
+#include <FrameArena.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace {
+	// ring of the current thread
+	thread_local void* tRing = nullptr;
+}
+
+Profiler& Profiler::instance() {
+	static Profiler profiler;
+	return profiler;
+}
+
+Profiler::Profiler()
+	: mEpoch{ std::chrono::steady_clock::now() } {
+}
+
+uint64_t Profiler::now() const {
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mEpoch).count());
+}
+
+Profiler::Ring& Profiler::threadRing() {
+	if (tRing == nullptr) {
+		// once per thread, the rings live as long as the profiler
+		std::lock_guard<std::mutex> lock(mRingsMutex);
+		mRings.push_back(std::make_unique<Ring>());
+		tRing = mRings.back().get();
+	}
+	return *static_cast<Ring*>(tRing);
+}
+
+void Profiler::record(const char* name, const uint64_t start, const uint64_t end) {
+	auto& ring = threadRing();
+	const auto head = ring.head.load(std::memory_order_relaxed);
+	if (head - ring.tail.load(std::memory_order_acquire) >= Ring::Capacity) {
+		ring.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	ring.samples[head % Ring::Capacity] = { name, start, end - start, 0 };
+	ring.head.store(head + 1, std::memory_order_release);
+}
+
+void Profiler::collect() {
+	FrameVector<Ring*> rings;
+	{
+		std::lock_guard<std::mutex> lock(mRingsMutex);
+		for (const auto& ring : mRings) {
+			rings.push_back(ring.get());
+		}
+	}
+
+	for (uint32_t thread = 0; thread < rings.size(); ++thread) {
+		auto& ring = *rings[thread];
+		mDropped += ring.dropped.exchange(0, std::memory_order_relaxed);
+		// the owner does not write past tail + Capacity, so these slots hold still until tail moves
+		const auto head = ring.head.load(std::memory_order_acquire);
+		for (auto tail = ring.tail.load(std::memory_order_relaxed); tail < head; ++tail) {
+			auto sample = ring.samples[tail % Ring::Capacity];
+			sample.thread = thread;
+
+			auto& window = mWindows[sample.name];
+			const double milliseconds = sample.duration / 1.0e6;
+			if (window.durations.size() < WindowSize) {
+				window.durations.push_back(milliseconds);
+			}
+			else {
+				window.durations[window.next] = milliseconds;
+			}
+			window.next = (window.next + 1) % WindowSize;
+
+			if (mRecording) {
+				mTrace.push_back(sample);
+			}
+		}
+		ring.tail.store(head, std::memory_order_release);
+	}
+}
+
+Profiler::Percentiles Profiler::percentiles(const std::string& name) const {
+	const auto found = mWindows.find(name);
+	if (found == mWindows.end() || found->second.durations.empty()) {
+		return {};
+	}
+
+	const auto& window = found->second.durations;
+	FrameVector<double> durations(window.begin(), window.end());
+	auto at = [&](const double fraction) {
+		const auto nth = durations.begin() + static_cast<size_t>(fraction * (durations.size() - 1));
+		std::nth_element(durations.begin(), nth, durations.end());
+		return *nth;
+	};
+	return { at(0.50), at(0.95), at(0.99) };
+}
+
+std::vector<std::string> Profiler::phases() const {
+	std::vector<std::string> names;
+	for (const auto& window : mWindows) {
+		names.push_back(window.first);
+	}
+	return names;
+}
+
+bool Profiler::writeCsv(const std::string& path) const {
+	std::ofstream out(path);
+	out << std::fixed << std::setprecision(3);
+	out << "phase,thread,start_us,duration_us\n";
+	for (const auto& sample : mTrace) {
+		out << sample.name << ',' << sample.thread << ',' << sample.start / 1.0e3 << ',' << sample.duration / 1.0e3 << '\n';
+	}
+	return static_cast<bool>(out);
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const {
+	std::ofstream out(path);
+	out << std::fixed << std::setprecision(3);
+	out << "{\"traceEvents\":[";
+	for (size_t i = 0; i < mTrace.size(); ++i) {
+		const auto& sample = mTrace[i];
+		out << (i == 0 ? "" : ",") << "\n{\"name\":\"" << sample.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << sample.thread
+			<< ",\"ts\":" << sample.start / 1.0e3 << ",\"dur\":" << sample.duration / 1.0e3 << '}';
+	}
+	out << "\n]}\n";
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Scoped phase timings. Every thread writes into its own fixed-size ring without locking, and
+// drops new samples while the ring is full rather than overwrite ones collect() may be reading;
+// collect() drains the rings into per-phase percentile windows and, while recording, into a trace
+// that can be exported as CSV or Chrome trace JSON (chrome://tracing, Perfetto).
+class Profiler {
+public:
+	struct Sample {
+		// phase names must be string literals, only the pointer is kept
+		const char* name;
+		uint64_t start;
+		uint64_t duration;
+		uint32_t thread;
+	};
+
+	struct Percentiles {
+		double p50{ 0.0 };
+		double p95{ 0.0 };
+		double p99{ 0.0 };
+	};
+
+	// durations kept per phase for the percentiles
+	static constexpr size_t WindowSize = 512;
+
+	static Profiler& instance();
+
+	// nanoseconds since the profiler was created
+	uint64_t now() const;
+	void record(const char* name, const uint64_t start, const uint64_t end);
+
+	// Drains the rings of every thread; call from one thread only, e.g. once per frame.
+	void collect();
+	// milliseconds over the last WindowSize samples of a phase, zeros when it never ran
+	Percentiles percentiles(const std::string& name) const;
+	std::vector<std::string> phases() const;
+	// samples lost because a ring filled up between two collect() calls
+	size_t dropped() const { return mDropped; }
+
+	// keep every collected sample for export until stopRecording()
+	void startRecording() { mRecording = true; }
+	void stopRecording() { mRecording = false; }
+	bool writeCsv(const std::string& path) const;
+	bool writeChromeTrace(const std::string& path) const;
+
+private:
+	struct Ring {
+		static constexpr size_t Capacity = 1 << 14;
+		std::array<Sample, Capacity> samples;
+		// written by the owning thread only
+		std::atomic<uint64_t> head{ 0 };
+		// written by the collecting thread only, once it is done with the samples before it
+		std::atomic<uint64_t> tail{ 0 };
+		// samples the owning thread found no room for
+		std::atomic<uint64_t> dropped{ 0 };
+	};
+
+	struct Window {
+		std::vector<double> durations;
+		size_t next{ 0 };
+	};
+
+	Profiler();
+	Ring& threadRing();
+
+	std::chrono::steady_clock::time_point mEpoch;
+	mutable std::mutex mRingsMutex;
+	std::vector<std::unique_ptr<Ring>> mRings;
+
+	std::map<std::string, Window> mWindows;
+	std::vector<Sample> mTrace;
+	bool mRecording{ false };
+	size_t mDropped{ 0 };
+};
+
+// Times the enclosing scope under name, a string literal.
+class ProfileScope {
+public:
+	explicit ProfileScope(const char* name)
+		: mName{ name }
+		, mStart{ Profiler::instance().now() } {
+	}
+	~ProfileScope() {
+		auto& profiler = Profiler::instance();
+		profiler.record(mName, mStart, profiler.now());
+	}
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	const char* mName;
+	uint64_t mStart;
+};
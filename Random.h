@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace GameJamAsteroids {
+	// seed used by the headless modes unless one is given
+	constexpr uint64_t DefaultSeed = 0x2545F4914F6CDD1Dull;
+
+	// SplitMix64 finalizer, spreads nearby inputs such as consecutive ids over the whole range
+	constexpr uint64_t mixSeed(uint64_t value) {
+		value += 0x9E3779B97F4A7C15ull;
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+
+	// What a counter-based draw is for; the stream is part of every counter, so the uses never
+	// share values.
+	enum class RandomStream : uint32_t {
+		// ship placement and color at creation
+		Ships,
+		// initial particle state, one draw per component
+		Particles,
+		// particles spawned by the emitters, one draw per component
+		Respawn,
+		// MarkovPolicy decisions
+		Policy
+	};
+
+	// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3"): ten rounds of
+	// multiply and xor that map a 128-bit counter through a bijection keyed by the world seed. It
+	// keeps no state, so the value for (entity, stream, tick, draw) is the same whichever thread
+	// computes it and in whatever order. Initialization, respawns and agents draw in parallel
+	// and still repeat bit for bit at any thread count, and a loop over entities vectorizes.
+	class Philox {
+	public:
+		using Block = std::array<uint32_t, 4>;
+
+		explicit Philox(const uint64_t seed)
+			: mKey{ static_cast<uint32_t>(mixSeed(seed)), static_cast<uint32_t>(mixSeed(seed) >> 32u) } {
+		}
+
+		// four independent 32-bit values
+		Block operator()(const uint32_t entity, const RandomStream stream, const uint32_t tick, const uint32_t draw = 0) const {
+			Block block;
+			generate(entity, stream, tick, draw, block[0], block[1], block[2], block[3]);
+			return block;
+		}
+
+		// The blocks of entities [first, first + count), one array per lane, 8 entities at a time
+		// with AVX2 (SSE2 has no faster path than scalar 64-bit multiplies). Bit-identical to
+		// calling operator() for each.
+		void generate(const uint32_t first, const size_t count, const RandomStream stream, const uint32_t tick, const uint32_t draw, uint32_t* lane0, uint32_t* lane1, uint32_t* lane2, uint32_t* lane3) const {
+			size_t k = 0;
+#if defined(__AVX2__)
+			for (; k + 8 <= count; k += 8) {
+				generate8(first + static_cast<uint32_t>(k), stream, tick, draw, lane0 + k, lane1 + k, lane2 + k, lane3 + k);
+			}
+#endif
+			for (; k < count; ++k) {
+				generate(first + static_cast<uint32_t>(k), stream, tick, draw, lane0[k], lane1[k], lane2[k], lane3[k]);
+			}
+		}
+
+		// in [0, 1)
+		static float uniform(const uint32_t value) {
+			return static_cast<float>(value >> 8u) * (1.0f / 16777216.0f);
+		}
+
+		// in [0, bound), by multiply and shift; the bias is below bound / 2^32
+		static uint32_t below(const uint32_t value, const uint32_t bound) {
+			return static_cast<uint32_t>((static_cast<uint64_t>(value) * bound) >> 32u);
+		}
+
+	private:
+		void generate(uint32_t c0, const RandomStream stream, uint32_t c2, uint32_t c3, uint32_t& out0, uint32_t& out1, uint32_t& out2, uint32_t& out3) const {
+			uint32_t c1 = static_cast<uint32_t>(stream);
+			uint32_t key0 = mKey[0];
+			uint32_t key1 = mKey[1];
+			for (int round = 0; round < 10; ++round) {
+				const uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+				const uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+				c0 = static_cast<uint32_t>(product1 >> 32u) ^ c1 ^ key0;
+				c1 = static_cast<uint32_t>(product1);
+				c2 = static_cast<uint32_t>(product0 >> 32u) ^ c3 ^ key1;
+				c3 = static_cast<uint32_t>(product0);
+				key0 += 0x9E3779B9u;
+				key1 += 0xBB67AE85u;
+			}
+			out0 = c0;
+			out1 = c1;
+			out2 = c2;
+			out3 = c3;
+		}
+
+#if defined(__AVX2__)
+		// 32 x 32 -> 64 bit products of all eight lanes, split into high and low halves
+		static void mulHiLo(const __m256i a, const __m256i multiplier, __m256i& high, __m256i& low) {
+			const __m256i even = _mm256_mul_epu32(a, multiplier);
+			const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), multiplier);
+			low = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+			high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+		}
+
+		void generate8(const uint32_t first, const RandomStream stream, const uint32_t tick, const uint32_t draw, uint32_t* out0, uint32_t* out1, uint32_t* out2, uint32_t* out3) const {
+			__m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(first)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+			__m256i c1 = _mm256_set1_epi32(static_cast<int>(stream));
+			__m256i c2 = _mm256_set1_epi32(static_cast<int>(tick));
+			__m256i c3 = _mm256_set1_epi32(static_cast<int>(draw));
+			const __m256i m0 = _mm256_set1_epi32(static_cast<int>(0xD2511F53u));
+			const __m256i m1 = _mm256_set1_epi32(static_cast<int>(0xCD9E8D57u));
+			uint32_t key0 = mKey[0];
+			uint32_t key1 = mKey[1];
+			for (int round = 0; round < 10; ++round) {
+				__m256i high0, low0, high1, low1;
+				mulHiLo(c0, m0, high0, low0);
+				mulHiLo(c2, m1, high1, low1);
+				c0 = _mm256_xor_si256(_mm256_xor_si256(high1, c1), _mm256_set1_epi32(static_cast<int>(key0)));
+				c1 = low1;
+				c2 = _mm256_xor_si256(_mm256_xor_si256(high0, c3), _mm256_set1_epi32(static_cast<int>(key1)));
+				c3 = low0;
+				key0 += 0x9E3779B9u;
+				key1 += 0xBB67AE85u;
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out0), c0);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out1), c1);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out2), c2);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(out3), c3);
+		}
+#endif
+
+		std::array<uint32_t, 2> mKey;
+	};
+}
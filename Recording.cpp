@@ -0,0 +1,363 @@
+#include <Recording.h>
+#include <GameLoop.h>
+#include <Random.h>
+#include <Renderer.h>
+#include <ShipSystem.h>
+#include <World.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+
+namespace GameJamAsteroids {
+	namespace {
+		constexpr char Magic[4] = { 'G', 'J', 'A', 'R' };
+		constexpr uint32_t Version = 1;
+		// first varint of a record: keyframes are 1, ticks are changes << 1
+		constexpr uint64_t KeyframeTag = 1;
+		// px, py, vx, vy, heading, speed, acceleration
+		constexpr size_t KeyframeColumns = 7;
+		constexpr size_t FlushSize = 1 << 16;
+
+		void putU32(std::vector<uint8_t>& out, const uint32_t value) {
+			for (int shift = 0; shift < 32; shift += 8) {
+				out.push_back(static_cast<uint8_t>(value >> shift));
+			}
+		}
+
+		void putU64(std::vector<uint8_t>& out, const uint64_t value) {
+			putU32(out, static_cast<uint32_t>(value));
+			putU32(out, static_cast<uint32_t>(value >> 32));
+		}
+
+		void putF32(std::vector<uint8_t>& out, const float value) {
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			putU32(out, bits);
+		}
+
+		void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+			while (value >= 0x80) {
+				out.push_back(static_cast<uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back(static_cast<uint8_t>(value));
+		}
+
+		// Bounds-checked little-endian reads; every read fails once one has.
+		struct Reader {
+			const std::vector<uint8_t>& data;
+			size_t offset;
+			bool ok{ true };
+
+			bool has(const size_t bytes) {
+				ok = ok && offset + bytes <= data.size();
+				return ok;
+			}
+
+			uint32_t u32() {
+				if (!has(4)) {
+					return 0;
+				}
+				uint32_t value = 0;
+				for (int i = 0; i < 4; ++i) {
+					value |= static_cast<uint32_t>(data[offset++]) << (8 * i);
+				}
+				return value;
+			}
+
+			uint64_t u64() {
+				const uint64_t low = u32();
+				return low | (static_cast<uint64_t>(u32()) << 32);
+			}
+
+			float f32() {
+				const auto bits = u32();
+				float value;
+				std::memcpy(&value, &bits, sizeof(value));
+				return value;
+			}
+
+			uint64_t varint() {
+				uint64_t value = 0;
+				for (int shift = 0; shift < 64; shift += 7) {
+					if (!has(1)) {
+						return 0;
+					}
+					const auto byte = data[offset++];
+					value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0) {
+						return value;
+					}
+				}
+				ok = false;
+				return 0;
+			}
+		};
+
+		uint8_t actionPair(const ShipActions& actions, const size_t i) {
+			if (i >= actions.steering.size()) {
+				return 0;
+			}
+			return static_cast<uint8_t>(static_cast<int>(actions.steering[i]) * 3 + static_cast<int>(actions.speed[i]));
+		}
+
+		// the ship columns a keyframe stores, in file order
+		template <typename EcsT>
+		auto keyframeColumns(EcsT& ecs) {
+			auto& positions = ecs.template data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+			auto& velocities = ecs.template data<ecs::EntityType::Ship, ecs::ComponentType::Velocity>();
+			return std::array<decltype(positions.x.data()), KeyframeColumns>{
+				positions.x.data(), positions.y.data(), velocities.x.data(), velocities.y.data(),
+				ecs.template data<ecs::EntityType::Ship, ecs::ComponentType::Heading>().data(),
+				ecs.template data<ecs::EntityType::Ship, ecs::ComponentType::Speed>().data(),
+				ecs.template data<ecs::EntityType::Ship, ecs::ComponentType::Acceleration>().data()
+			};
+		}
+	}
+
+	ActionRecorder::ActionRecorder(const std::string& path, const World& world, const float dt, const size_t keyframeInterval)
+		: mFile{ path, std::ios::binary | std::ios::trunc }
+		, mInterval{ std::max<size_t>(1, keyframeInterval) }
+		, mShipCount{ shipCount(world.ecs) } {
+		for (const auto c : Magic) {
+			mBuffer.push_back(static_cast<uint8_t>(c));
+		}
+		putU32(mBuffer, Version);
+		putU32(mBuffer, static_cast<uint32_t>(world.width));
+		putU32(mBuffer, static_cast<uint32_t>(world.height));
+		putU32(mBuffer, static_cast<uint32_t>(mShipCount));
+		putF32(mBuffer, dt);
+		mBuffer.push_back(world.integrator == Integrator::Simd ? 1 : 0);
+		putU32(mBuffer, static_cast<uint32_t>(mInterval));
+		putU64(mBuffer, world.seed);
+		for (const auto color : world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Color>()) {
+			putU32(mBuffer, color.toInteger());
+		}
+		writeKeyframe(world);
+		flush();
+	}
+
+	ActionRecorder::~ActionRecorder() {
+		flush();
+	}
+
+	void ActionRecorder::writeKeyframe(const World& world) {
+		putVarint(mBuffer, KeyframeTag);
+		putU64(mBuffer, mTicks);
+		for (const auto column : keyframeColumns(world.ecs)) {
+			for (size_t i = 0; i < mShipCount; ++i) {
+				putF32(mBuffer, column[i]);
+			}
+		}
+		mPrevious.resize(mShipCount);
+		for (size_t i = 0; i < mShipCount; ++i) {
+			mPrevious[i] = actionPair(world.shipActions, i);
+			mBuffer.push_back(mPrevious[i]);
+		}
+	}
+
+	bool ActionRecorder::record(const World& world) {
+		if (!mFile || shipCount(world.ecs) != mShipCount) {
+			return false;
+		}
+
+		const auto& actions = world.shipActions;
+		size_t changes = 0;
+		for (size_t i = 0; i < mShipCount; ++i) {
+			changes += actionPair(actions, i) != mPrevious[i] ? 1 : 0;
+		}
+		putVarint(mBuffer, static_cast<uint64_t>(changes) << 1);
+
+		size_t next = 0;
+		for (size_t i = 0; i < mShipCount; ++i) {
+			const auto pair = actionPair(actions, i);
+			if (pair == mPrevious[i]) {
+				continue;
+			}
+			// one of the eight other pairs, counted on from the previous one
+			const auto change = (pair + 9 - mPrevious[i] - 1) % 9;
+			putVarint(mBuffer, static_cast<uint64_t>(i - next) * 8 + change);
+			mPrevious[i] = pair;
+			next = i + 1;
+		}
+
+		++mTicks;
+		if (mTicks % mInterval == 0) {
+			writeKeyframe(world);
+		}
+		if (mBuffer.size() >= FlushSize) {
+			flush();
+		}
+		return static_cast<bool>(mFile);
+	}
+
+	void ActionRecorder::flush() {
+		if (!mBuffer.empty()) {
+			mFile.write(reinterpret_cast<const char*>(mBuffer.data()), static_cast<std::streamsize>(mBuffer.size()));
+			mFile.flush();
+			mBytes += mBuffer.size();
+			mBuffer.clear();
+		}
+	}
+
+	ActionReplay::ActionReplay(const std::string& path) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file) {
+			mError = "cannot open " + path;
+			return;
+		}
+		mData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+		mOpen = readHeader() && indexRecords();
+	}
+
+	bool ActionReplay::readHeader() {
+		if (mData.size() < sizeof(Magic) || !std::equal(std::begin(Magic), std::end(Magic), mData.begin())) {
+			mError = "not an action recording";
+			return false;
+		}
+		Reader in{ mData, sizeof(Magic) };
+		if (in.u32() != Version) {
+			mError = "unsupported recording version";
+			return false;
+		}
+		mWidth = in.u32();
+		mHeight = in.u32();
+		mShipCount = in.u32();
+		mDt = in.f32();
+		mIntegrator = in.has(1) && mData[in.offset++] == 1 ? Integrator::Simd : Integrator::Scalar;
+		in.u32();
+		mSeed = in.u64();
+		if (!in.has(static_cast<size_t>(mShipCount) * 4)) {
+			mError = "truncated header";
+			return false;
+		}
+		mColors.resize(mShipCount);
+		for (auto& color : mColors) {
+			color = in.u32();
+		}
+		mOffset = in.offset;
+		return in.ok;
+	}
+
+	bool ActionReplay::indexRecords() {
+		const size_t keyframeSize = 8 + static_cast<size_t>(mShipCount) * (KeyframeColumns * 4 + 1);
+		Reader in{ mData, mOffset };
+		while (in.offset < mData.size()) {
+			const auto start = in.offset;
+			const auto tag = in.varint();
+			if (tag == KeyframeTag) {
+				const auto tick = in.u64();
+				if (!in.has(keyframeSize - 8) || tick != mTicks) {
+					break;
+				}
+				in.offset += keyframeSize - 8;
+				mKeyframes.push_back({ mTicks, start });
+				continue;
+			}
+			for (uint64_t change = 0; change < (tag >> 1) && in.ok; ++change) {
+				in.varint();
+			}
+			if (!in.ok) {
+				break;
+			}
+			++mTicks;
+		}
+
+		if (mKeyframes.empty() || mKeyframes.front().tick != 0) {
+			mError = "recording has no initial keyframe";
+			return false;
+		}
+		return true;
+	}
+
+	World ActionReplay::createWorld() {
+		World world = GameJamAsteroids::createWorld(mWidth, mHeight, 0, 0, mSeed);
+		// the recorded actions fly the ships, whatever policy made them
+		world.policy.reset();
+		world.integrator = mIntegrator;
+		std::vector<ecs::Color> colors(mShipCount);
+		std::transform(mColors.begin(), mColors.end(), colors.begin(), [](const uint32_t color) { return ecs::Color(color); });
+		spawnShips(world.ecs, std::vector<ecs::Vec2f>(mShipCount), colors);
+		restoreKeyframe(world, mKeyframes.front());
+		return world;
+	}
+
+	bool ActionReplay::restoreKeyframe(World& world, const Keyframe& keyframe) {
+		if (shipCount(world.ecs) != mShipCount) {
+			return false;
+		}
+		Reader in{ mData, keyframe.offset };
+		in.varint();
+		in.u64();
+		for (const auto column : keyframeColumns(world.ecs)) {
+			for (size_t i = 0; i < mShipCount; ++i) {
+				column[i] = in.f32();
+			}
+		}
+		mActions.assign(mData.begin() + in.offset, mData.begin() + in.offset + mShipCount);
+		mOffset = in.offset + mShipCount;
+		mTick = keyframe.tick;
+		world.tick = keyframe.tick;
+		return in.ok;
+	}
+
+	bool ActionReplay::seek(World& world, const size_t tick) {
+		const auto target = std::min(tick, mTicks);
+		const auto keyframe = std::upper_bound(mKeyframes.begin(), mKeyframes.end(), target, [](const size_t t, const Keyframe& k) { return t < k.tick; }) - 1;
+		if (!restoreKeyframe(world, *keyframe)) {
+			return false;
+		}
+		while (mTick < target && step(world)) {
+		}
+		return mTick == target;
+	}
+
+	bool ActionReplay::step(World& world) {
+		if (mTick >= mTicks) {
+			return false;
+		}
+
+		Reader in{ mData, mOffset };
+		auto tag = in.varint();
+		while (tag == KeyframeTag) {
+			// keyframes only matter when seeking, the state is already here
+			in.offset += 8 + static_cast<size_t>(mShipCount) * (KeyframeColumns * 4 + 1);
+			tag = in.varint();
+		}
+		size_t index = 0;
+		for (uint64_t change = 0; change < (tag >> 1); ++change) {
+			const auto value = in.varint();
+			index += static_cast<size_t>(value >> 3);
+			if (!in.ok || index >= mActions.size()) {
+				return false;
+			}
+			mActions[index] = static_cast<uint8_t>((mActions[index] + (value & 7) + 1) % 9);
+			++index;
+		}
+		mOffset = in.offset;
+
+		auto& actions = world.shipActions;
+		actions.resize(mShipCount);
+		for (size_t i = 0; i < mShipCount; ++i) {
+			actions.steering[i] = static_cast<SteeringState>(mActions[i] / 3);
+			actions.speed[i] = static_cast<SpeedState>(mActions[i] % 3);
+		}
+		GameLoop::step(world, mDt);
+		++mTick;
+		return true;
+	}
+
+	uint64_t fleetChecksum(const World& world) {
+		uint64_t hash = mixSeed(shipCount(world.ecs));
+		for (const auto column : keyframeColumns(world.ecs)) {
+			for (size_t i = 0; i < shipCount(world.ecs); ++i) {
+				uint32_t bits;
+				std::memcpy(&bits, &column[i], sizeof(bits));
+				hash = mixSeed(hash ^ bits);
+			}
+		}
+		return hash;
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <Agent.h>
+#include <Simulation.h>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+struct World;
+
+namespace GameJamAsteroids {
+	// ticks between full ship-state keyframes, one simulated minute
+	constexpr size_t DefaultKeyframeInterval = 3600;
+
+	// Logs what the fleet did so a run can be replayed without its policy. The file starts with a
+	// header (world size, step, integrator, seed, ship colors). Then one record per tick lists
+	// only the ships whose action pair changed: varint(gap * 8 + change), gap being the number of
+	// unchanged ships skipped. Every keyframe interval, a keyframe holds the full ship state and
+	// actions, so a replay can start there. Values are little-endian.
+	class ActionRecorder {
+	public:
+		ActionRecorder(const std::string& path, const World& world, const float dt, const size_t keyframeInterval = DefaultKeyframeInterval);
+		~ActionRecorder();
+
+		bool isOpen() const { return static_cast<bool>(mFile); }
+		// Appends the actions of the tick just simulated, call after every step. Fails when the
+		// ship count changed or the file cannot be written.
+		bool record(const World& world);
+		size_t ticks() const { return mTicks; }
+		size_t bytesWritten() const { return mBytes + mBuffer.size(); }
+
+	private:
+		void writeKeyframe(const World& world);
+		void flush();
+
+		std::ofstream mFile;
+		size_t mInterval;
+		size_t mShipCount;
+		size_t mTicks{ 0 };
+		size_t mBytes{ 0 };
+		// last action pair per ship, steering * 3 + speed
+		std::vector<uint8_t> mPrevious;
+		std::vector<uint8_t> mBuffer;
+	};
+
+	// Plays a recording back through GameLoop::step as fast as the simulation runs.
+	class ActionReplay {
+	public:
+		// Loads the file and indexes its keyframes. A recording cut short, e.g. by a crash,
+		// replays up to its last complete tick.
+		explicit ActionReplay(const std::string& path);
+
+		bool isOpen() const { return mOpen; }
+		const std::string& error() const { return mError; }
+		// complete ticks in the file
+		size_t ticks() const { return mTicks; }
+		float dt() const { return mDt; }
+		uint64_t seed() const { return mSeed; }
+		// next tick step() simulates
+		size_t tick() const { return mTick; }
+
+		// The recorded ships as they were at tick 0, with no policy and no particles.
+		World createWorld();
+		// Restores the last keyframe at or before tick, then simulates up to it.
+		bool seek(World& world, const size_t tick);
+		// Simulates the next recorded tick, false once the recording is exhausted.
+		bool step(World& world);
+
+	private:
+		struct Keyframe {
+			size_t tick;
+			size_t offset;
+		};
+
+		bool readHeader();
+		bool indexRecords();
+		bool restoreKeyframe(World& world, const Keyframe& keyframe);
+
+		std::vector<uint8_t> mData;
+		bool mOpen{ false };
+		std::string mError;
+
+		uint32_t mWidth{ 0 };
+		uint32_t mHeight{ 0 };
+		uint32_t mShipCount{ 0 };
+		float mDt{ 0.0f };
+		Integrator mIntegrator{ Integrator::Simd };
+		uint64_t mSeed{ 0 };
+		std::vector<uint32_t> mColors;
+
+		std::vector<Keyframe> mKeyframes;
+		size_t mTicks{ 0 };
+		size_t mTick{ 0 };
+		size_t mOffset{ 0 };
+		std::vector<uint8_t> mActions;
+	};
+
+	// Hash of every ship's kinematic state, equal for runs that went exactly the same way.
+	uint64_t fleetChecksum(const World& world);
+}
@@ -0,0 +1,110 @@
+#include <RemotePolicy.h>
+#include <Profiler.h>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace GameJamAsteroids {
+	namespace {
+		constexpr size_t CacheLine = 64;
+
+		size_t alignUp(const size_t offset) {
+			return (offset + CacheLine - 1) / CacheLine * CacheLine;
+		}
+
+		uint8_t clampAction(const uint8_t action) {
+			// anything a misbehaving server writes outside the enums is Continue
+			return action <= 2 ? action : 0;
+		}
+	}
+
+	size_t PolicyChannel::bytes(const size_t capacity) {
+		const auto floats = alignUp(capacity * sizeof(float));
+		const auto actions = alignUp(capacity);
+		return alignUp(sizeof(PolicyChannelHeader)) + 6 * floats + 2 * actions;
+	}
+
+	PolicyChannel PolicyChannel::map(void* data, const size_t capacity) {
+		const auto floats = alignUp(capacity * sizeof(float));
+		const auto actions = alignUp(capacity);
+		auto* bytes = static_cast<uint8_t*>(data);
+		PolicyChannel channel;
+		channel.header = static_cast<PolicyChannelHeader*>(data);
+		auto* next = bytes + alignUp(sizeof(PolicyChannelHeader));
+		for (float** array : { &channel.x, &channel.y, &channel.heading, &channel.speed, &channel.vx, &channel.vy }) {
+			*array = reinterpret_cast<float*>(next);
+			next += floats;
+		}
+		channel.steering = next;
+		channel.throttle = next + actions;
+		return channel;
+	}
+
+	RemotePolicy::RemotePolicy(const std::string& name, const size_t capacity)
+		: mCapacity{ capacity } {
+		mMemory = SharedMemory::create(name, PolicyChannel::bytes(capacity));
+		if (!mMemory) {
+			return;
+		}
+		mChannel = PolicyChannel::map(mMemory->data(), capacity);
+		// the segment starts zeroed, the atomics only need constructing
+		auto* header = new (mChannel.header) PolicyChannelHeader{};
+		header->version = PolicyChannel::Version;
+		header->capacity = static_cast<uint32_t>(capacity);
+		mRequest = std::make_unique<SharedSignal>(PolicyChannel::requestSignal(name), header->request);
+		mResponse = std::make_unique<SharedSignal>(PolicyChannel::responseSignal(name), header->response);
+		header->magic.store(PolicyChannel::Magic, std::memory_order_release);
+	}
+
+	RemotePolicy::~RemotePolicy() {
+		if (mMemory) {
+			mChannel.header->closed.store(1, std::memory_order_relaxed);
+			mRequest->notify(++mSequence);
+		}
+	}
+
+	void RemotePolicy::resize(const size_t count) {
+		(void)count;
+	}
+
+	void RemotePolicy::prepare(const ShipObservations& observations) {
+		mAnswered = false;
+		if (!mMemory) {
+			return;
+		}
+		ProfileScope scope("policyServer");
+		const auto count = std::min(observations.count, mCapacity);
+		auto* header = mChannel.header;
+		header->shipCount = static_cast<uint32_t>(count);
+		header->width = observations.width;
+		header->height = observations.height;
+		std::memcpy(mChannel.x, observations.x, count * sizeof(float));
+		std::memcpy(mChannel.y, observations.y, count * sizeof(float));
+		std::memcpy(mChannel.heading, observations.heading, count * sizeof(float));
+		std::memcpy(mChannel.speed, observations.speed, count * sizeof(float));
+		std::memcpy(mChannel.vx, observations.vx, count * sizeof(float));
+		std::memcpy(mChannel.vy, observations.vy, count * sizeof(float));
+		++header->tick;
+		mRequest->notify(++mSequence);
+
+		const auto deadline = std::chrono::steady_clock::now() + Timeout;
+		for (auto seen = mResponse->value(); seen != mSequence; seen = mResponse->value()) {
+			const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+			if (remaining.count() <= 0 || !mResponse->wait(seen, remaining)) {
+				++mTimeouts;
+				return;
+			}
+		}
+		mAnswered = true;
+	}
+
+	void RemotePolicy::act(const ShipObservations& observations, ShipActions& actions, const size_t begin, const size_t end) {
+		const auto answered = mAnswered ? std::min(observations.count, mCapacity) : 0;
+		for (size_t k = begin; k < end; ++k) {
+			const bool remote = k < answered;
+			actions.steering[k] = remote ? static_cast<SteeringState>(clampAction(mChannel.steering[k])) : SteeringState::Continue;
+			actions.speed[k] = remote ? static_cast<SpeedState>(clampAction(mChannel.throttle[k])) : SpeedState::Continue;
+		}
+	}
+}
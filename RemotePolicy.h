@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Agent.h>
+#include <SharedMemory.h>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace GameJamAsteroids {
+	// Start of the segment a RemotePolicy shares with a policy server. The arrays behind it hold
+	// capacity entries each, of which the first shipCount belong to the current request.
+	struct PolicyChannelHeader {
+		// stored last, once the rest of the header is written; a server seeing 0 retries
+		std::atomic<uint32_t> magic;
+		uint32_t version;
+		uint32_t capacity;
+		uint32_t shipCount;
+		uint64_t tick;
+		float width;
+		float height;
+		// The sim bumps request after writing the observations; the server stores the request it
+		// answered in response after writing the actions.
+		std::atomic<uint32_t> request;
+		std::atomic<uint32_t> response;
+		// set when the sim goes away
+		std::atomic<uint32_t> closed;
+		uint32_t reserved;
+	};
+
+	// The segment's arrays, each starting on its own cache line. Actions are SteeringState and
+	// SpeedState values, one byte per ship.
+	struct PolicyChannel {
+		static constexpr uint32_t Magic = 0x50414a47; // "GJAP"
+		static constexpr uint32_t Version = 1;
+
+		PolicyChannelHeader* header{ nullptr };
+		float* x{ nullptr };
+		float* y{ nullptr };
+		float* heading{ nullptr };
+		float* speed{ nullptr };
+		float* vx{ nullptr };
+		float* vy{ nullptr };
+		uint8_t* steering{ nullptr };
+		uint8_t* throttle{ nullptr };
+
+		static size_t bytes(const size_t capacity);
+		static PolicyChannel map(void* data, const size_t capacity);
+		static std::string requestSignal(const std::string& name) { return name + "-request"; }
+		static std::string responseSignal(const std::string& name) { return name + "-response"; }
+	};
+
+	// Hands the fleet to a policy server in another process through shared memory, without
+	// serializing anything. Every tick prepare() copies the observations into the segment, wakes
+	// the server and waits for its actions; ships the server did not answer for keep Continue.
+	class RemotePolicy : public IPolicy {
+	public:
+		// how long a tick waits for the server before it goes on without it
+		static constexpr auto Timeout = std::chrono::milliseconds(1000);
+
+		// Creates the segment under name for up to capacity ships.
+		RemotePolicy(const std::string& name, const size_t capacity);
+		~RemotePolicy() override;
+
+		bool isOpen() const { return mMemory != nullptr; }
+		// ticks the server left unanswered
+		size_t timeouts() const { return mTimeouts; }
+
+		void resize(const size_t count) override;
+		void prepare(const ShipObservations& observations) override;
+		void act(const ShipObservations& observations, ShipActions& actions, const size_t begin, const size_t end) override;
+
+	private:
+		size_t mCapacity;
+		std::unique_ptr<SharedMemory> mMemory;
+		PolicyChannel mChannel;
+		std::unique_ptr<SharedSignal> mRequest;
+		std::unique_ptr<SharedSignal> mResponse;
+		uint32_t mSequence{ 0 };
+		bool mAnswered{ false };
+		size_t mTimeouts{ 0 };
+	};
+}
@@ -0,0 +1,50 @@
+#include <RenderBackend.h>
+
+SfmlBackend::SfmlBackend(sf::RenderWindow& window)
+	: mWindow{ window } {
+}
+
+void SfmlBackend::clear(const sf::Color color) {
+	mWindow.clear(color);
+	mNextBuffer = 0;
+}
+
+void SfmlBackend::draw(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type) {
+	if (count == 0) {
+		return;
+	}
+
+	// availability needs a live context, so it is only asked once the window exists
+	if (!mBufferChecked) {
+		mBufferChecked = true;
+		mUseBuffers = sf::VertexBuffer::isAvailable();
+	}
+
+	if (mUseBuffers) {
+		if (mNextBuffer == mBuffers.size()) {
+			mBuffers.push_back(std::make_unique<sf::VertexBuffer>(type, sf::VertexBuffer::Stream));
+		}
+		auto& buffer = *mBuffers[mNextBuffer++];
+		buffer.setPrimitiveType(type);
+		if (buffer.getVertexCount() < count && !buffer.create(count)) {
+			mUseBuffers = false;
+		}
+		else if (buffer.update(vertices, count, 0)) {
+			mWindow.draw(buffer, 0, count);
+			return;
+		}
+	}
+	mWindow.draw(vertices, count, type);
+}
+
+void SfmlBackend::display() {
+	mWindow.display();
+}
+
+sf::View SfmlBackend::getView() const {
+	return mWindow.getView();
+}
+
+sf::Vector2u SfmlBackend::getSize() const {
+	return mWindow.getSize();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <SFML/Graphics/PrimitiveType.hpp>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/VertexBuffer.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <memory>
+#include <vector>
+
+// Where the renderers send their vertices: the SFML window, or the software rasterizer for
+// hosts without a display.
+class RenderBackend {
+public:
+	virtual ~RenderBackend() = default;
+
+	virtual void clear(const sf::Color color) = 0;
+	virtual void draw(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type) = 0;
+	virtual void display() = 0;
+
+	virtual sf::View getView() const = 0;
+	virtual sf::Vector2u getSize() const = 0;
+};
+
+// Draws through an SFML window. Every draw call of a frame streams through its own vertex buffer
+// when the driver has them, so buffers keep their capacity from frame to frame.
+class SfmlBackend : public RenderBackend {
+public:
+	explicit SfmlBackend(sf::RenderWindow& window);
+
+	void clear(const sf::Color color) override;
+	void draw(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type) override;
+	void display() override;
+
+	sf::View getView() const override;
+	sf::Vector2u getSize() const override;
+
+private:
+	sf::RenderWindow& mWindow;
+	std::vector<std::unique_ptr<sf::VertexBuffer>> mBuffers;
+	size_t mNextBuffer{ 0 };
+	bool mBufferChecked{ false };
+	bool mUseBuffers{ false };
+};
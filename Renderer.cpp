@@ -1,13 +1,24 @@
 
 // Copyright (C) David Dalstrm 2020
 #include <Renderer.h>
+#include <AllocationCounter.h>
+#include <Checkpoint.h>
+#include <FrameArena.h>
 #include <GameLoop.h>
+#include <JobSystem.h>
+#include <Profiler.h>
+#include <Random.h>
+#include <Recording.h>
+#include <RemotePolicy.h>
+#include <ShipSystem.h>
+#include <SoftwareRasterizer.h>
+#include <World.h>
 
 #include <algorithm>
 #include <cstdlib>
 #include <cstdio>
 #include <cmath>
-#include <execution>
+#include <filesystem>
 #include <fstream>
 #include <glm/glm.hpp>
 #include <vector>
@@ -16,7 +27,6 @@
 #include <chrono>
 #include <functional>
 #include <random>
-#include <execution>
 #include <unordered_map>
 
 #include <SFML/Graphics/RenderWindow.hpp>
@@ -29,11 +39,11 @@
 #include <Agent.h>
 
 namespace GameJamAsteroids {
-	static const std::default_random_engine generator;
-	static const std::uniform_real_distribution<float> normalizedDist(0.0f, 100.f);
-
 	const double PI = glm::atan(1) * 4;
 
+	// ship hulls laid out by one job
+	constexpr size_t ShipsPerJob = 256;
+
 	float mix(const float a, const float b, const float mix) {
 		return b * mix + a * (1 - mix);
 	}
@@ -42,249 +52,480 @@ namespace GameJamAsteroids {
 		return x >= 0.0f ? 1 : -1;
 	}
 
-	void simulation(sf::RenderWindow& window, const size_t width, const size_t height, std::vector<ecs::Vec3f>& positions, std::vector<ecs::Vec3f>& velocities, Ship& ship, const float dt) {
-		constexpr float friction = 0.9975f;
-		constexpr float gravity = 0.025f;
-		constexpr float shipGravityFactor = 0.02f;
-		
-		// create some gravity wells
-		const float dx = 1.0f, dy = 1.0f;
-		const sf::Vector3f refPoint{ static_cast<float>(width / 2), static_cast<float>(height / 2), 1.0f };
-		std::vector<sf::Vector3f> wells = { refPoint };
-		for (int i = 0; i < 0; ++i) {
-			wells.push_back(refPoint + sf::Vector3f{ -dx * i, dy * i, 1.0f });
-			wells.push_back(refPoint + sf::Vector3f{ dx * i, dy * i, 1.0f });
-		}
-		
-		const auto deviation = sf::Vector3f{ cos(dt) * gravity, sin(dt) * gravity, 0.0f };
+	void drawSnapshot(RenderBackend& backend, const WorldSnapshot& previous, const WorldSnapshot& current, float alpha, float rad, ParticleRenderer& particles, FleetRenderer& fleet) {
+		particles.setView(backend.getView(), backend.getSize());
+		particles.update(&previous.particlePositions, &previous.particleHandles, current.particleHandles, current.particlePositions, current.particleSizes, current.particleColors, current.particleAngularVelocities, alpha, { current.width, current.height }, rad);
+		particles.draw(backend);
+
+		const bool interpolate = previous.ships.size() == current.ships.size();
+		fleet.resize(current.ships.size());
+		JobSystem::instance().parallelFor(current.ships.size(), ShipsPerJob, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				auto ship = current.ships[i];
+				if (interpolate) {
+					const auto& from = previous.ships[i];
+					ship.position.x = lerpWrapped(from.position.x, ship.position.x, alpha, current.width);
+					ship.position.y = lerpWrapped(from.position.y, ship.position.y, alpha, current.height);
+					ship.heading = mix(from.heading, ship.heading, alpha);
+				}
+				fleet.setShip(i, ship.position, ship.heading, ship.color);
+			}
+		});
+		fleet.draw(backend);
+	}
 
-		constexpr size_t quota = 1;
-		static std::vector<size_t> range(positions.size() / quota);
-		auto initRange = [&]() {
-			std::generate_n(range.begin(), positions.size() / quota, [n = 0]() mutable { return n++; });
-		};
-		static std::once_flag once;
-		std::call_once(once, initRange);
-
-		const auto shipPos = ship.position();
-		auto shipGravityWell = [&](size_t i) {
-			for (size_t k = quota * i, end = (i + 1) * quota; k < end; ++k) {
-				auto& pos = positions[k];
-				ecs::Vec3f pull = pos - wells[0];
-				pull = pull / (pull.x * pull.x + pull.y * pull.y);
-				ecs::Vec3f deflect = pos - shipPos;
-				deflect = deflect / (1.0f + deflect.x * deflect.x + deflect.y * deflect.y);
-
-				auto& velocity = velocities[k];
-				velocity *= friction;
-				velocity -= shipGravityFactor * deflect;
-
-				pos += dt * velocity;
-				pos.x = pos.x < 2560.f ? (pos.x > 0.0f ? pos.x : 2559.f) : 0.0f;
-				pos.y = pos.y < 1440.f ? (pos.y > 0.0f ? pos.y : 1439.f) : 0.0f;
+	void drawCircles(sf::RenderWindow& window, const std::vector<ecs::Vec3f>& positions, std::vector<ecs::Vec3f>& velocities, Ship& ship) {
+
+	}
+
+	ecs::EntityRange initEntities(size_t width, size_t height, ECS& ecs, size_t count, uint64_t seed) {
+		// particle k of the batch draws component c from Philox at (k, c), whatever chunk or thread
+		// it lands in; set(i, a, b) gets two of the four values for particle first + i
+		const Philox random(seed);
+		auto forEach = [&random](const size_t first, const size_t n, const ecs::ComponentType component, auto&& set) {
+			constexpr size_t Batch = 256;
+			uint32_t draws[4][Batch];
+			for (size_t begin = 0; begin < n; begin += Batch) {
+				const auto batch = std::min(Batch, n - begin);
+				random.generate(static_cast<uint32_t>(first + begin), batch, RandomStream::Particles, 0, static_cast<uint32_t>(component), draws[0], draws[1], draws[2], draws[3]);
+				for (size_t k = 0; k < batch; ++k) {
+					set(begin + k, Philox::uniform(draws[0][k]), draws[1][k]);
+				}
 			}
 		};
 
-		auto pushPull = [&](size_t i) {
-			for (size_t k = quota * i, end = (i + 1) * quota; k < end; ++k) {
-				auto& pos = positions[k];
-				ecs::Vec3f pull{ 0.f, 0.f, 0.f };
-				for (const auto& gravityWell : wells) {
-					auto wellDist = pos - gravityWell;
-					auto absDist = 1.0f + wellDist.x * wellDist.x + wellDist.y * wellDist.y;
-					pull += gravityWell.z * wellDist / absDist;
-				}
-				ecs::Vec3f deflect = pos - shipPos;
-				deflect = deflect / (1.0f + deflect.x * deflect.x + deflect.y * deflect.y);
+		const float side = 1.5f;
+		return ecs.createEntities<ecs::EntityType::Square>(count,
+			ecs::column<ecs::ComponentType::Color>([&](ecs::Color* out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::Color, [out](const size_t i, const float u, uint32_t) {
+					out[i] = { /*255.f * normalized()*/0, static_cast<sf::Uint8>(64.0f + 128.0f * u), /*255.f * normalized()*/0 };
+				});
+			}),
+			ecs::column<ecs::ComponentType::Velocity>([&](ecs::Vec2Pointer out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::Velocity, [out](const size_t i, const float u, const uint32_t v) {
+					out.x[i] = 0.01f * u;
+					out.y[i] = 0.1f * Philox::uniform(v);
+				});
+			}),
+			ecs::column<ecs::ComponentType::Position>([&](ecs::Vec2Pointer out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::Position, [out, width, height](const size_t i, const float u, const uint32_t v) {
+					out.x[i] = width * u;
+					out.y[i] = height * Philox::uniform(v);
+				});
+			}),
+			ecs::column<ecs::ComponentType::Size>([&](ecs::Size* out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::Size, [out, side](const size_t i, const float u, const uint32_t v) {
+					out[i].x = side + u * side;
+					out[i].y = side + Philox::uniform(v) * side;
+				});
+			}),
+			ecs::column<ecs::ComponentType::AngularVelocity>([&](ecs::AngularVelocity* out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::AngularVelocity, [out](const size_t i, const float u, uint32_t) {
+					out[i] = 1.0f + 0.1f * u;
+				});
+			}),
+			ecs::column<ecs::ComponentType::TimeToLive>([&](ecs::TimeToLive* out, size_t first, size_t n) {
+				forEach(first, n, ecs::ComponentType::TimeToLive, [out](const size_t i, float, const uint32_t v) {
+					out[i] = static_cast<ecs::TimeToLive>(500 + 10 * Philox::below(v, 101));
+				});
+			}));
+	}
 
-				auto& velocity = velocities[k];
-				velocity *= friction;
-				velocity -= gravity * pull;
-				velocity += shipGravityFactor * deflect;
+	void handleKeyboardEvent(sf::Event event, Ship& ship, sf::RenderWindow& window) {
+		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)) {
+			window.close();
+		}
+		ship.handleKeyboardEvent(event);
+	}
 
-				pos += dt * velocity;
-				pos.x = pos.x < width ? (pos.x > 0.0f ? pos.x : width - 1 ) : 0.0f;
-				pos.y = pos.y < height ? (pos.y > 0.0f ? pos.y : height - 1) : 0.0f;
+	World createWorld(size_t width, size_t height, size_t shipCount, size_t quadCount, uint64_t seed) {
+		World world;
+		world.width = width;
+		world.height = height;
+		world.seed = seed;
+		world.wells = createWells(width, height);
+		world.shipGrid.reset(static_cast<float>(width), static_cast<float>(height), ShipGridCell);
+		world.particleGrid.reset(static_cast<float>(width), static_cast<float>(height), ParticleGridCell);
+		std::vector<ecs::Vec2f> shipPositions(shipCount);
+		std::vector<ecs::Color> shipColors(shipCount);
+		const Philox random(seed);
+		JobSystem::instance().parallelFor(shipCount, ShipsPerJob, [&](const size_t begin, const size_t end) {
+			for (size_t i = begin; i < end; ++i) {
+				const auto color = random(static_cast<uint32_t>(i), RandomStream::Ships, 0, 0);
+				const auto position = random(static_cast<uint32_t>(i), RandomStream::Ships, 0, 1);
+				shipColors[i] = { static_cast<sf::Uint8>(Philox::below(color[0], 256)), static_cast<sf::Uint8>(Philox::below(color[1], 256)), static_cast<sf::Uint8>(Philox::below(color[2], 256)) };
+				shipPositions[i] = { static_cast<float>(Philox::below(position[0], static_cast<uint32_t>(width))), static_cast<float>(Philox::below(position[1], static_cast<uint32_t>(height))) };
 			}
-		};
+		});
+		spawnShips(world.ecs, shipPositions, shipColors);
+		world.policy = std::make_unique<MarkovPolicy>(seed);
 
-		std::for_each(std::execution::par, range.begin(), range.end(), pushPull);
-		//std::for_each(std::execution::par, range.begin(), range.end(), shipGravityWell);
+		if (quadCount > 0) {
+			initEntities(width, height, world.ecs, quadCount, seed);
+		}
+		world.particles.capacity = quadCount;
+		return world;
 	}
 
-	void drawQuads(sf::RenderWindow& window, ECS& ecs, float rad) {
-		auto& positions = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
-		auto& velocities = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Velocity>();
-		auto& sizes = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Size>();
-		auto& colors = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Color>();
-		auto& angular = ecs.data<ecs::EntityType::Square, ecs::ComponentType::AngularVelocity>();
-		auto& entities = ecs.entities<ecs::EntityType::Square>();
+	void runGame(size_t width, size_t height, const std::string& resumePath) {
+		constexpr size_t quadCount = 100000;
 
-		auto normalized = std::bind(normalizedDist, generator);
+		World world;
+		std::string error;
+		if (resumePath.empty()) {
+			// a new world every time the game starts
+			world = createWorld(width, height, 10, quadCount, std::random_device{}());
+		}
+		else if (!loadCheckpoint(resumePath, world, error)) {
+			std::cerr << resumePath << ": " << error << std::endl;
+			return;
+		}
 
-		auto distanceSqr = [](const sf::Vector2f a, const sf::Vector2f b) -> float {
-			auto xdiff = a.x - b.x;
-			auto ydiff = a.y - b.y;
-			return xdiff * xdiff + ydiff * ydiff;
-		};
+		sf::RenderWindow window(sf::VideoMode(width, height), "Birds of Pray", sf::Style::Default);
+		window.setTitle("Birds of Pray");
+		window.setVerticalSyncEnabled(true);
+		
+		GameLoop loop;
+		loop.run(window, world);
+	}
 
-		std::vector<sf::Vertex> vertices(4 * positions.size());
-		auto random = rand() % 1000;
-
-		static bool doStrobe = false;
-// 		static int interval = 100;
-// 		if (random > interval) {
-// 			doStrobe = !doStrobe;
-// 			if (interval == 100) {
-// 				interval = 10;
-// 			}
-// 			else interval = 100;
-// 		}
-
-		size_t index = 0;
-		size_t n = 0;
-
-		const auto cosRad = cos(rad);
-		const auto sinRad = sin(rad);
-
-		for (auto& pos : positions) {
-			// layout vertices in a quad pattern
-			auto& entity = entities[n];
-			if (entity.ttl <= 0) {
-				pos.y = pos.x = 0.0f;
-				velocities[n].x = 0.025f;
-				velocities[n].y = 0.001f;
-				entity.ttl = 3000 + 20 * normalized();
-				continue;
+	void runHeadless(size_t width, size_t height, const HeadlessOptions& options) {
+		World world;
+		double loadSeconds = 0.0;
+		if (options.resumePath.empty()) {
+			world = createWorld(width, height, options.shipCount, options.quadCount, options.seed);
+			world.integrator = options.integrator;
+		}
+		else {
+			// resumes with the integrator it was saved with, so the run continues exactly
+			const auto start = std::chrono::steady_clock::now();
+			std::string error;
+			if (!loadCheckpoint(options.resumePath, world, error)) {
+				std::cerr << options.resumePath << ": " << error << std::endl;
+				return;
 			}
-			entity.ttl--;
-			auto& pos = positions[n];
-			auto& color = colors[n];
-			auto& size = sizes[n];
-			auto& angle = angular[n];
-			auto& velocity = velocities[n++];
-			
-			
-			sf::Uint8 red{ static_cast<sf::Uint8>(color.x) }, green{ static_cast<sf::Uint8>(color.y) }, blue{ static_cast<sf::Uint8>(color.z) };
-			sf::Color sfColor = { red, green, blue, 64 };
-
-			if (doStrobe) {
-				sf::Vector2f coneEnd{ 1280.0f + 640.0f * cosRad, 720.0f + 360.0f * sinRad };
-				sf::Vector2f pos2d{ pos.x, pos.y };
-				sf::Vector2f coneCenter{ 1280.0f, 720.0f };
-				auto particleDir = coneCenter - pos2d;
-				auto coneDir = coneCenter - coneEnd;
-				auto dotProd = coneDir.x * particleDir.x + coneDir.y * particleDir.y;
-				auto sonarMagnitude = sqrtf(coneDir.x * coneDir.x + coneDir.y * coneDir.y);
-				auto pos2dMagnitude = sqrtf(particleDir.x * particleDir.x + particleDir.y * particleDir.y);
-				auto angle = acos(dotProd / (sonarMagnitude * pos2dMagnitude));
-				if (angle < 0.4f && normalized() < 1.0f && pos2dMagnitude < 700.0f + 6*normalized() && pos2dMagnitude > 20.0f+1 * normalized()) {
-					sfColor = sf::Color{ 212, 175, 55 };
-				}
+			loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+		world.field.setEngine(options.forceEngine);
+		RemotePolicy* remote = nullptr;
+		if (!options.policyServer.empty()) {
+			auto policy = std::make_unique<RemotePolicy>(options.policyServer, shipCount(world.ecs));
+			if (!policy->isOpen()) {
+				std::cerr << "cannot create shared memory " << options.policyServer << std::endl;
+				return;
 			}
+			remote = policy.get();
+			world.policy = std::move(policy);
+		}
+		if (!options.recordPath.empty()) {
+			world.recorder = std::make_unique<ActionRecorder>(options.recordPath, world, GameLoop::FixedStep);
+			if (!world.recorder->isOpen()) {
+				std::cerr << "cannot write " << options.recordPath << std::endl;
+				return;
+			}
+		}
 
-			const ecs::Vec3f ul{ pos.x - size.x, pos.y - size.y, 0.0f };
-			const ecs::Vec3f ur{ pos.x + size.x, pos.y - size.y, 0.0f };
-			const ecs::Vec3f lr{ pos.x + size.x, pos.y + size.y, 0.0f };
-			const ecs::Vec3f ll{ pos.x - size.x, pos.y + size.y, 0.0f };
+		GameLoop loop;
+		const auto stats = loop.runHeadless(world, options.ticks);
+
+		std::cout << "headless: " << stats.ticks << " ticks, " << shipCount(world.ecs) << " ships, " << world.ecs.entities<ecs::EntityType::Square>().size() << " particles, " << integratorName(world.integrator) << " integrator, " << forceEngineName(world.field.activeEngine()) << " force field, " << JobSystem::instance().threadCount() << " threads" << std::endl;
+		std::cout << "  wall time:          " << stats.wallSeconds << " s" << std::endl;
+		std::cout << "  ticks/sec:          " << stats.ticksPerSecond << std::endl;
+		std::cout << "  simulated sec/sec:  " << stats.simulatedSecondsPerSecond << std::endl;
+		std::cout << "  heap allocs/tick:   " << stats.allocationsPerTick << " (second half)" << std::endl;
+		std::cout << "  ship contacts:      " << world.collisions.shipContacts << std::endl;
+		std::cout << "  particle contacts:  " << world.collisions.particleContacts << std::endl;
+		std::cout << "  fleet checksum:     " << std::hex << fleetChecksum(world) << std::dec << std::endl;
+		if (world.recorder) {
+			std::cout << "  recorded:           " << world.recorder->ticks() << " ticks, " << world.recorder->bytesWritten() << " bytes to " << options.recordPath << std::endl;
+		}
+		if (!options.resumePath.empty()) {
+			std::cout << "  resumed:            " << options.resumePath << " in " << loadSeconds * 1000.0 << " ms, now at tick " << world.tick << std::endl;
+		}
+		if (!options.checkpointPath.empty()) {
+			const auto start = std::chrono::steady_clock::now();
+			if (!saveCheckpoint(world, options.checkpointPath)) {
+				std::cerr << "cannot write " << options.checkpointPath << std::endl;
+			}
+			else {
+				const std::chrono::duration<double> saveTime = std::chrono::steady_clock::now() - start;
+				std::cout << "  checkpoint:         " << options.checkpointPath << " in " << saveTime.count() * 1000.0 << " ms" << std::endl;
+			}
+		}
+		if (remote) {
+			const auto roundTrip = Profiler::instance().percentiles("policyServer");
+			std::cout << "  policy round trip:  us p50/p95/p99 " << roundTrip.p50 * 1000.0 << "/" << roundTrip.p95 * 1000.0 << "/" << roundTrip.p99 * 1000.0 << ", " << remote->timeouts() << " ticks unanswered" << std::endl;
+		}
+	}
 
-			vertices[index++] = sf::Vertex(Ship::rotate2D({ ul.x, ul.y }, rad * angle.z, { pos.x, pos.y }), sfColor);
-			vertices[index++] = sf::Vertex(Ship::rotate2D({ ur.x, ur.y }, rad * angle.z, { pos.x, pos.y }), sfColor);
-			vertices[index++] = sf::Vertex(Ship::rotate2D({ lr.x, lr.y }, rad * angle.z, { pos.x, pos.y }), sfColor);
-			vertices[index++] = sf::Vertex(Ship::rotate2D({ ll.x, ll.y }, rad * angle.z, { pos.x, pos.y }), sfColor);
+	int replayRecording(const std::string& path, const size_t from, const size_t to) {
+		ActionReplay replay(path);
+		if (!replay.isOpen()) {
+			std::cerr << path << ": " << replay.error() << std::endl;
+			return 2;
 		}
 
-		window.draw(&vertices[0], vertices.size(), sf::Quads);
+		World world = replay.createWorld();
+		const auto start = std::chrono::steady_clock::now();
+		replay.seek(world, from);
+		const auto seeked = std::chrono::steady_clock::now();
+		const auto last = std::min(to, replay.ticks());
+		while (replay.tick() < last && replay.step(world)) {
+		}
+		const std::chrono::duration<double> seekTime = seeked - start;
+		const std::chrono::duration<double> replayTime = std::chrono::steady_clock::now() - seeked;
+
+		std::cout << "replay: " << shipCount(world.ecs) << " ships, " << replay.ticks() << " ticks recorded, seed " << replay.seed() << std::endl;
+		std::cout << "  seek to " << from << ":        " << seekTime.count() << " s" << std::endl;
+		std::cout << "  replayed to " << replay.tick() << ":   " << replayTime.count() << " s" << std::endl;
+		std::cout << "  fleet checksum:     " << std::hex << fleetChecksum(world) << std::dec << std::endl;
+		return 0;
 	}
 
-	void drawCircles(sf::RenderWindow& window, const std::vector<ecs::Vec3f>& positions, std::vector<ecs::Vec3f>& velocities, Ship& ship) {
+	int verifyForceField(size_t width, size_t height, const HeadlessOptions& options) {
+		World world = createWorld(width, height, options.shipCount, options.quadCount, options.seed);
+		world.field.setEngine(ForceField::Engine::Grid);
+		buildForceField(world.field, world.wells, world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>(), width, height);
+
+		// every particle, plus rings around every ship from well inside the kernel peak outwards
+		const auto& particles = world.ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
+		std::vector<float> xs(particles.x.begin(), particles.x.end());
+		std::vector<float> ys(particles.y.begin(), particles.y.end());
+		const auto& ships = world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+		for (size_t i = 0; i < ships.size(); ++i) {
+			for (const float distance : { 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 24.0f, 32.0f, 48.0f, 64.0f, 128.0f }) {
+				for (int direction = 0; direction < 8; ++direction) {
+					const float angle = static_cast<float>(PI) * direction / 4.0f + 0.3f;
+					const float x = ships.x[i] + distance * std::cos(angle);
+					const float y = ships.y[i] + distance * std::sin(angle);
+					if (x >= 0.0f && x < width && y >= 0.0f && y < height) {
+						xs.push_back(x);
+						ys.push_back(y);
+					}
+				}
+			}
+		}
 
+		const auto error = world.field.gridError(xs.data(), ys.data(), xs.size());
+		std::cout << "grid vs exact force field, " << world.field.sourceCount() << " sources: max relative error " << error << " over " << xs.size() << " points, bound " << ForceField::GridErrorBound << std::endl;
+		return error <= ForceField::GridErrorBound ? 0 : 1;
 	}
 
-	void initEntities(size_t width, size_t height, ECS& ecs) {
-		std::default_random_engine generator;
-		std::uniform_real_distribution<float> normalizedFloatDist(0.0f, 1.0f);
-		auto normalizedFloat = std::bind(normalizedFloatDist, generator);
-
-		std::uniform_int_distribution<unsigned int> normalizedDist(0, 100);
-		auto normalized = std::bind(normalizedDist, generator);
-
-		auto& positions = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
-		auto& velocities = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Velocity>();
-		auto& sizes = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Size>();
-		auto& colors = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Color>();
-		auto& angular = ecs.data<ecs::EntityType::Square, ecs::ComponentType::AngularVelocity>();
-		auto& entities = ecs.entities<ecs::EntityType::Square>();
-
-		for (auto& color : colors) {
-			color.x = /*255.f * normalized()*/0.0f;
-			color.y = 64.0f + 128.0f * normalizedFloat();
-			color.z = /*255.f * normalized()*/0.0f;
-		}
-		
-		for (auto& v : velocities) {
-			v.x = 0.01f * normalizedFloat();
-			v.y = 0.1f * normalizedFloat();
-			v.z = 0.0f;
-		}
+	namespace {
+		// Cycles every ship through the actions on its own schedule, nothing a replay could recreate
+		// from the seed.
+		struct ScriptedPolicy : IPolicy {
+			size_t tick{ 0 };
+
+			void resize(const size_t) override {}
+			void prepare(const ShipObservations&) override { ++tick; }
+			void act(const ShipObservations&, ShipActions& actions, const size_t begin, const size_t end) override {
+				for (size_t i = begin; i < end; ++i) {
+					actions.steering[i] = static_cast<SteeringState>((i + tick / 30) % 3);
+					actions.speed[i] = static_cast<SpeedState>((7 * i + tick / 45) % 3);
+				}
+			}
+		};
+	}
 
-		for (auto& pos : positions) {
-			pos.x = width * normalizedFloat();
-			pos.y = height * normalizedFloat();
+	int verifyReplay(size_t width, size_t height, const HeadlessOptions& options) {
+		const auto path = (std::filesystem::temp_directory_path() / "GameJamAsteroids-verify-replay.rec").string();
+		const auto keyframeInterval = std::max<size_t>(1, options.ticks / 4);
+
+		uint64_t checksum = 0;
+		{
+			World world = createWorld(width, height, options.shipCount, 0, options.seed);
+			world.integrator = options.integrator;
+			world.policy = std::make_unique<ScriptedPolicy>();
+			world.recorder = std::make_unique<ActionRecorder>(path, world, GameLoop::FixedStep, keyframeInterval);
+			if (!world.recorder->isOpen()) {
+				std::cerr << "cannot write " << path << std::endl;
+				return 2;
+			}
+			GameLoop().runHeadless(world, options.ticks);
+			checksum = fleetChecksum(world);
 		}
 
-		const float side = 1.5f;
-		for (auto& size : sizes) {
-			size.x = side + normalizedFloat() * side;
-			size.y = side + normalizedFloat() * side;
-			size.z = 0.0f;
+		// from the start, and from past a later keyframe
+		bool matched = true;
+		for (const size_t from : { size_t{ 0 }, 2 * keyframeInterval + keyframeInterval / 2 }) {
+			ActionReplay replay(path);
+			if (!replay.isOpen()) {
+				std::cerr << path << ": " << replay.error() << std::endl;
+				return 2;
+			}
+			World world = replay.createWorld();
+			replay.seek(world, from);
+			while (replay.step(world)) {
+			}
+			const auto replayed = fleetChecksum(world);
+			std::cout << "replay from " << from << ": fleet checksum " << std::hex << replayed << ", recorded " << checksum << std::dec << std::endl;
+			matched = matched && replayed == checksum && replay.tick() == options.ticks;
 		}
+		std::filesystem::remove(path);
+		return matched ? 0 : 1;
+	}
+
+	int verifyCheckpoint(size_t width, size_t height, const HeadlessOptions& options) {
+		const auto path = (std::filesystem::temp_directory_path() / "GameJamAsteroids-verify-checkpoint.ck").string();
+		const auto saveAt = options.ticks / 2;
+		auto create = [&] {
+			World world = createWorld(width, height, options.shipCount, options.quadCount, options.seed);
+			world.integrator = options.integrator;
+			world.field.setEngine(options.forceEngine);
+			return world;
+		};
+
+		World straight = create();
+		GameLoop().runHeadless(straight, options.ticks);
+		const auto checksum = fleetChecksum(straight);
 
-		for (auto& angle : angular) {
-			angle.x = 0.0f;
-			angle.y = 0.0f;
-			angle.z = 1.0f + 0.1f * normalizedFloat();
+		{
+			World first = create();
+			GameLoop().runHeadless(first, saveAt);
+			if (!saveCheckpoint(first, path)) {
+				std::cerr << "cannot write " << path << std::endl;
+				return 2;
+			}
+		}
+		World resumed;
+		std::string error;
+		if (!loadCheckpoint(path, resumed, error)) {
+			std::cerr << path << ": " << error << std::endl;
+			return 2;
+		}
+		resumed.field.setEngine(options.forceEngine);
+		GameLoop().runHeadless(resumed, options.ticks - saveAt);
+		const auto restored = fleetChecksum(resumed);
+		std::cout << "saved at " << saveAt << ", resumed to " << resumed.tick << ": fleet checksum " << std::hex << restored << ", uninterrupted " << checksum << std::dec << std::endl;
+		bool passed = restored == checksum && resumed.tick == straight.tick;
+
+		// the same checkpoint cut short must be refused, whatever it lost
+		const auto size = std::filesystem::file_size(path);
+		const auto truncatedPath = path + ".truncated";
+		for (const auto keep : { size - 1, size / 2, size_t{ 16 } }) {
+			std::filesystem::copy_file(path, truncatedPath, std::filesystem::copy_options::overwrite_existing);
+			std::filesystem::resize_file(truncatedPath, keep);
+			World truncated;
+			const bool loaded = loadCheckpoint(truncatedPath, truncated, error);
+			std::cout << "truncated to " << keep << " of " << size << " bytes: " << (loaded ? "loaded" : "refused, " + error) << std::endl;
+			passed = passed && !loaded;
 		}
+		std::filesystem::remove(truncatedPath);
+		std::filesystem::remove(path);
+		return passed ? 0 : 1;
+	}
+
+	int verifyIntegrator(size_t width, size_t height, const HeadlessOptions& options) {
+		constexpr float tolerance = 0.001f;
+
+		World world = createWorld(width, height, options.shipCount, options.quadCount, options.seed);
+		world.field.setEngine(options.forceEngine);
+		buildForceField(world.field, world.wells, world.ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>(), width, height);
 
-		for (auto& entity : entities) {
-			entity.ttl = static_cast<int>(500 + 10*normalized());
+		auto& positions = world.ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
+		auto& velocities = world.ecs.data<ecs::EntityType::Square, ecs::ComponentType::Velocity>();
+		const auto deviation = integratorDeviation(width, height, positions, velocities, world.field, GameLoop::FixedStep, options.ticks);
+		const auto shipDeviation = shipIntegratorDeviation(width, height, world.ecs, world.seed, GameLoop::FixedStep, options.ticks);
+
+		std::cout << "scalar vs " << integratorName(Integrator::Simd) << " (" << forceEngineName(world.field.activeEngine()) << " force field): max position deviation " << deviation << " after " << options.ticks << " ticks" << std::endl;
+		std::cout << "ships: max position deviation " << shipDeviation << std::endl;
+		return deviation <= tolerance && shipDeviation <= tolerance ? 0 : 1;
+	}
+
+	int renderFrame(size_t width, size_t height, const HeadlessOptions& options, const std::string& path) {
+		constexpr int frames = 10;
+
+		World world = createWorld(width, height, options.shipCount, options.quadCount, options.seed);
+		world.integrator = options.integrator;
+		world.field.setEngine(options.forceEngine);
+		GameLoop loop;
+		loop.runHeadless(world, options.ticks);
+
+		WorldSnapshot snapshot;
+		captureSnapshot(world, options.ticks, snapshot);
+		const float rad = GameLoop::SpinRate * options.ticks / GameLoop::TickRate;
+
+		// the same frame a few times over, the last one is saved
+		SoftwareRasterizer rasterizer(static_cast<unsigned int>(width), static_cast<unsigned int>(height));
+		ParticleRenderer particles;
+		FleetRenderer fleet;
+		const auto start = std::chrono::steady_clock::now();
+		for (int frame = 0; frame < frames; ++frame) {
+			rasterizer.clear(sf::Color::Black);
+			drawSnapshot(rasterizer, snapshot, snapshot, 1.0f, rad, particles, fleet);
+			rasterizer.display();
+			Profiler::instance().collect();
+			FrameArena::endFrame();
+		}
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+		const auto& stats = particles.stats();
+		std::cout << "software frame: " << stats.quads << " quads, " << stats.points << " points, " << snapshot.ships.size() << " ships, " << JobSystem::instance().threadCount() << " threads" << std::endl;
+		std::cout << "  frame time:         " << elapsed.count() / frames << " ms" << std::endl;
+		if (!rasterizer.saveToFile(path)) {
+			std::cerr << "could not write " << path << std::endl;
+			return 1;
 		}
+		return 0;
 	}
 
-	void handleKeyboardEvent(sf::Event event, Ship& ship, sf::RenderWindow& window) {
-		if (sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)) {
-			window.close();
+	int verifyAllocations(size_t width, size_t height, const HeadlessOptions& options) {
+		World world = createWorld(width, height, options.shipCount, options.quadCount, options.seed);
+		world.integrator = options.integrator;
+		world.field.setEngine(options.forceEngine);
+		SoftwareRasterizer rasterizer(static_cast<unsigned int>(width), static_cast<unsigned int>(height));
+		ParticleRenderer particles;
+		FleetRenderer fleet;
+		WorldSnapshot snapshots[2];
+
+		// counted over the second half, by when the first particles have expired and been replaced
+		const auto warmUp = options.ticks / 2;
+		uint64_t allocations = 0;
+		for (size_t tick = 0; tick < options.ticks; ++tick) {
+			if (tick == warmUp) {
+				allocations = allocationCounts().allocations;
+			}
+			GameLoop::step(world, GameLoop::FixedStep);
+			auto& current = snapshots[tick % 2];
+			captureSnapshot(world, tick, current);
+			rasterizer.clear(sf::Color::Black);
+			drawSnapshot(rasterizer, snapshots[(tick + 1) % 2], current, 0.5f, GameLoop::SpinRate * tick / GameLoop::TickRate, particles, fleet);
+			rasterizer.display();
+			Profiler::instance().collect();
+			FrameArena::endFrame();
 		}
-		ship.handleKeyboardEvent(event);
+		allocations = allocationCounts().allocations - allocations;
+
+		std::cout << "heap allocations over ticks " << warmUp << " to " << options.ticks << ": " << allocations << " (" << shipCount(world.ecs) << " ships, " << world.ecs.entities<ecs::EntityType::Square>().size() << " particles, software frame every tick, " << JobSystem::instance().threadCount() << " threads)" << std::endl;
+		return allocations == 0 ? 0 : 1;
 	}
 
-	void runGame(size_t width, size_t height) {
-		std::random_device randomDevice;
-		std::default_random_engine randomEngine(randomDevice());
-		std::uniform_int_distribution<int> uniform_dist(0, INT_MAX);
+	void writeProfile(const std::string& prefix) {
+		auto& profiler = Profiler::instance();
+		profiler.collect();
 
-		constexpr size_t quadCount = 100000;
-		
-		std::vector<Ship> ships;
-		for (int i = 0; i < 10; ++i) {
-			sf::Color color{ static_cast<sf::Uint8>(uniform_dist(randomEngine) % 256), static_cast<sf::Uint8>(uniform_dist(randomEngine) % 256), static_cast<sf::Uint8>(uniform_dist(randomEngine) % 256) };
-			ships.emplace_back(ecs::Vec3f{ static_cast<float>(uniform_dist(randomEngine) % width), static_cast<float>(uniform_dist(randomEngine) % height), 0.0f }, color, std::make_unique<MarkovAgent>());
+		std::cout << "profile (ms over the last " << Profiler::WindowSize << " samples)" << std::endl;
+		for (const auto& phase : profiler.phases()) {
+			const auto p = profiler.percentiles(phase);
+			std::printf("  %-12s p50 %8.3f  p95 %8.3f  p99 %8.3f\n", phase.c_str(), p.p50, p.p95, p.p99);
+		}
+		if (profiler.dropped() > 0) {
+			std::cout << "  " << profiler.dropped() << " samples dropped" << std::endl;
 		}
-		
-		/*
-		ECS ecs;
-		ecs.createEntity(ecs::EntityType::Square, { 0.0f, 1.0f, 0.0f }, quadCount);
-		auto& positions = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
-		auto& velocities = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Velocity>();
-		initEntities(width, height, ecs);
-		*/
 
-		sf::RenderWindow window(sf::VideoMode(width, height), "Birds of Pray", sf::Style::Default);
-		char windowTitle[255] = "Birds of Pray";
-		window.setTitle(windowTitle);
-		window.setVerticalSyncEnabled(true);
-		
-		GameLoop loop;
-		loop.run(window, ships);
+		if (!profiler.writeCsv(prefix + ".csv") || !profiler.writeChromeTrace(prefix + ".json")) {
+			std::cerr << "could not write " << prefix << ".csv/.json" << std::endl;
+		}
+	}
+
+	int compareImages(const std::string& a, const std::string& b, const int tolerance) {
+		ImageDiff diff;
+		if (!diffImages(a, b, diff)) {
+			std::cerr << "could not compare " << a << " and " << b << std::endl;
+			return 2;
+		}
+		std::cout << diff.differingPixels << " of " << static_cast<size_t>(diff.width) * diff.height << " pixels differ, max channel delta " << diff.maxChannelDelta << std::endl;
+		return diff.maxChannelDelta <= tolerance ? 0 : 1;
 	}
 }
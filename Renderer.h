@@ -1,7 +1,67 @@
 #pragma once
 
 #include <random>
+#include <string>
+#include <FleetRenderer.h>
+#include <ForceField.h>
+#include <ParticleRenderer.h>
+#include <Random.h>
+#include <Simulation.h>
+#include <Snapshot.h>
+#include <SFML/Graphics/RenderWindow.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+
+struct World;
 
 namespace GameJamAsteroids {
-	void runGame(size_t width, size_t height);
-}
\ No newline at end of file
+	struct HeadlessOptions {
+		size_t ticks{ 60 * 60 * 10 };
+		size_t quadCount{ 100000 };
+		size_t shipCount{ 10 };
+		Integrator integrator{ Integrator::Simd };
+		ForceField::Engine forceEngine{ ForceField::Engine::Auto };
+		// ship placement and agent decisions follow from it
+		uint64_t seed{ DefaultSeed };
+		// when set, runHeadless logs every tick's actions there
+		std::string recordPath;
+		// when set, the ships are flown by the policy server listening on this name
+		std::string policyServer;
+		// when set, the world is loaded from this checkpoint instead of being created
+		std::string resumePath;
+		// when set, runHeadless saves a checkpoint there at the end
+		std::string checkpointPath;
+	};
+
+	World createWorld(size_t width, size_t height, size_t shipCount, size_t quadCount, uint64_t seed = DefaultSeed);
+	// starts from the checkpoint at resumePath when one is given
+	void runGame(size_t width, size_t height, const std::string& resumePath = {});
+	// Draws particles and ships alpha of the way from previous to current; the renderers keep
+	// their vertex storage between frames.
+	void drawSnapshot(RenderBackend& backend, const WorldSnapshot& previous, const WorldSnapshot& current, float alpha, float rad, ParticleRenderer& particles, FleetRenderer& fleet);
+	void runHeadless(size_t width, size_t height, const HeadlessOptions& options);
+	// exit code 0 when the SIMD integrator tracks the scalar one within tolerance
+	int verifyIntegrator(size_t width, size_t height, const HeadlessOptions& options);
+	// exit code 0 when the grid force field stays within ForceField::GridErrorBound of the exact
+	// one at every particle and around every ship
+	int verifyForceField(size_t width, size_t height, const HeadlessOptions& options);
+	// Records options.ticks ticks flown by a scripted policy, replays the recording from the start
+	// and from past a later keyframe; exit code 0 when both end on the recorded fleet checksum.
+	int verifyReplay(size_t width, size_t height, const HeadlessOptions& options);
+	// Saves a checkpoint halfway through options.ticks ticks and resumes from it; exit code 0 when
+	// the resumed run ends on the fleet checksum of an uninterrupted one and the checkpoint cut
+	// short is refused.
+	int verifyCheckpoint(size_t width, size_t height, const HeadlessOptions& options);
+	// Simulates options.ticks ticks, draws the result with the software rasterizer and saves it
+	// to path (.ppm or any format sf::Image writes).
+	int renderFrame(size_t width, size_t height, const HeadlessOptions& options, const std::string& path);
+	// Simulates options.ticks ticks and rasterizes a software frame after every one; exit code 0
+	// when nothing was allocated from the heap over the second half.
+	int verifyAllocations(size_t width, size_t height, const HeadlessOptions& options);
+	// Replays a recording from tick from (via the nearest keyframe) up to tick to, as fast as it
+	// simulates, and prints the fleet checksum; exit code 2 when the file cannot be read.
+	int replayRecording(const std::string& path, const size_t from, const size_t to);
+	// Prints phase percentiles and writes every recorded sample to prefix.csv and prefix.json.
+	void writeProfile(const std::string& prefix);
+	// exit code 0 when no channel differs by more than tolerance, 1 when one does, 2 on errors
+	int compareImages(const std::string& a, const std::string& b, const int tolerance);
+}
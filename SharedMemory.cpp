@@ -0,0 +1,170 @@
+#include <SharedMemory.h>
+
+#include <thread>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) && std::atomic<uint32_t>::is_always_lock_free, "futex words must be plain 32-bit integers");
+
+namespace {
+#if defined(_WIN32)
+	std::string kernelName(const std::string& name) {
+		return "Local\\" + name;
+	}
+#else
+	std::string kernelName(const std::string& name) {
+		return "/" + name;
+	}
+#endif
+}
+
+std::unique_ptr<SharedMemory> SharedMemory::create(const std::string& name, const size_t bytes) {
+	std::unique_ptr<SharedMemory> memory(new SharedMemory());
+	memory->mName = kernelName(name);
+	memory->mSize = bytes;
+	memory->mOwner = true;
+#if defined(_WIN32)
+	memory->mMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(bytes) >> 32), static_cast<DWORD>(bytes), memory->mName.c_str());
+	if (memory->mMapping == nullptr) {
+		return nullptr;
+	}
+	memory->mData = MapViewOfFile(memory->mMapping, FILE_MAP_ALL_ACCESS, 0, 0, bytes);
+#else
+	// a leftover segment from a crashed run would have the wrong size
+	shm_unlink(memory->mName.c_str());
+	const int fd = shm_open(memory->mName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (fd < 0) {
+		return nullptr;
+	}
+	if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+		close(fd);
+		shm_unlink(memory->mName.c_str());
+		return nullptr;
+	}
+	void* data = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	memory->mData = data == MAP_FAILED ? nullptr : data;
+#endif
+	return memory->mData != nullptr ? std::move(memory) : nullptr;
+}
+
+std::unique_ptr<SharedMemory> SharedMemory::open(const std::string& name) {
+	std::unique_ptr<SharedMemory> memory(new SharedMemory());
+	memory->mName = kernelName(name);
+#if defined(_WIN32)
+	memory->mMapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, memory->mName.c_str());
+	if (memory->mMapping == nullptr) {
+		return nullptr;
+	}
+	memory->mData = MapViewOfFile(memory->mMapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+	MEMORY_BASIC_INFORMATION info{};
+	if (memory->mData != nullptr && VirtualQuery(memory->mData, &info, sizeof(info)) != 0) {
+		memory->mSize = info.RegionSize;
+	}
+#else
+	const int fd = shm_open(memory->mName.c_str(), O_RDWR, 0600);
+	if (fd < 0) {
+		return nullptr;
+	}
+	struct stat status {};
+	if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+		close(fd);
+		return nullptr;
+	}
+	memory->mSize = static_cast<size_t>(status.st_size);
+	void* data = mmap(nullptr, memory->mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	memory->mData = data == MAP_FAILED ? nullptr : data;
+#endif
+	return memory->mData != nullptr ? std::move(memory) : nullptr;
+}
+
+SharedMemory::~SharedMemory() {
+#if defined(_WIN32)
+	if (mData != nullptr) {
+		UnmapViewOfFile(mData);
+	}
+	if (mMapping != nullptr) {
+		CloseHandle(mMapping);
+	}
+#else
+	if (mData != nullptr) {
+		munmap(mData, mSize);
+	}
+	if (mOwner) {
+		shm_unlink(mName.c_str());
+	}
+#endif
+}
+
+SharedSignal::SharedSignal(const std::string& name, std::atomic<uint32_t>& word)
+	: mWord{ word } {
+#if defined(_WIN32)
+	// auto-reset, opened instead when the other process made it first
+	mEvent = CreateEventA(nullptr, FALSE, FALSE, ("Local\\" + name).c_str());
+#else
+	(void)name;
+#endif
+}
+
+SharedSignal::~SharedSignal() {
+#if defined(_WIN32)
+	if (mEvent != nullptr) {
+		CloseHandle(mEvent);
+	}
+#endif
+}
+
+void SharedSignal::notify(const uint32_t value) {
+	mWord.store(value, std::memory_order_release);
+#if defined(_WIN32)
+	SetEvent(mEvent);
+#elif defined(__linux__)
+	syscall(SYS_futex, reinterpret_cast<uint32_t*>(&mWord), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+
+bool SharedSignal::wait(const uint32_t seen, const std::chrono::microseconds timeout) const {
+	using Clock = std::chrono::steady_clock;
+	const auto start = Clock::now();
+	const auto deadline = start + timeout;
+	while (Clock::now() - start < SpinTime) {
+		if (value() != seen) {
+			return true;
+		}
+		std::this_thread::yield();
+	}
+
+	while (value() == seen) {
+		const auto now = Clock::now();
+		if (now >= deadline) {
+			return false;
+		}
+#if defined(_WIN32)
+		const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+		WaitForSingleObject(mEvent, static_cast<DWORD>(remaining));
+#elif defined(__linux__)
+		const auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+		timespec relative{ static_cast<time_t>(remaining / 1000000000), static_cast<long>(remaining % 1000000000) };
+		// returns at once when the word no longer holds seen
+		syscall(SYS_futex, reinterpret_cast<const uint32_t*>(&mWord), FUTEX_WAIT, seen, &relative, nullptr, 0);
+#else
+		std::this_thread::yield();
+#endif
+	}
+	return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Named memory shared with another local process: POSIX shared memory on Linux, a pagefile
+// backed file mapping on Windows. The process that created the name removes it again.
+class SharedMemory {
+public:
+	// nullptr when the segment cannot be created or mapped
+	static std::unique_ptr<SharedMemory> create(const std::string& name, const size_t bytes);
+	// nullptr while nobody has created the name yet
+	static std::unique_ptr<SharedMemory> open(const std::string& name);
+	~SharedMemory();
+	SharedMemory(const SharedMemory&) = delete;
+	SharedMemory& operator=(const SharedMemory&) = delete;
+
+	void* data() const { return mData; }
+	size_t size() const { return mSize; }
+
+private:
+	SharedMemory() = default;
+
+	std::string mName;
+	void* mData{ nullptr };
+	size_t mSize{ 0 };
+	bool mOwner{ false };
+#if defined(_WIN32)
+	void* mMapping{ nullptr };
+#endif
+};
+
+// Sequence counter in shared memory that one process bumps and the other waits on. Waiting
+// spins (yielding) for a short while, which covers a peer that answers within microseconds,
+// then sleeps: on a futex on Linux, on a named event on Windows, elsewhere by yielding.
+class SharedSignal {
+public:
+	// both processes use the same name, it only matters for the Windows event
+	SharedSignal(const std::string& name, std::atomic<uint32_t>& word);
+	~SharedSignal();
+	SharedSignal(const SharedSignal&) = delete;
+	SharedSignal& operator=(const SharedSignal&) = delete;
+
+	uint32_t value() const { return mWord.load(std::memory_order_acquire); }
+	// Publishes value and wakes the waiter. Everything written before is visible to it.
+	void notify(const uint32_t value);
+	// Waits until the word differs from seen; false on timeout.
+	bool wait(const uint32_t seen, const std::chrono::microseconds timeout) const;
+
+	static constexpr auto SpinTime = std::chrono::microseconds(50);
+
+private:
+	std::atomic<uint32_t>& mWord;
+#if defined(_WIN32)
+	void* mEvent{ nullptr };
+#endif
+};
@@ -9,22 +9,18 @@
 #include <random>
 #include <string>
 
-struct IAgent;
-enum class SteeringState;
-enum class SpeedState;
-
+// A ship steered by hand. The agent-driven fleet lives in the ECS, see ShipSystem.h.
 class Ship : protected sf::Drawable {
 public:
 	Ship(const ecs::Vec3f pos, sf::Color color);
-	Ship(const ecs::Vec3f pos, sf::Color color, std::unique_ptr<IAgent> agent);
 
 	void draw(sf::RenderTarget& target, sf::RenderStates states = sf::RenderStates::Default) const override;
-	void update(float dt);
 	void update(sf::RenderWindow& window, const float dt);
-	void update(float dt, SteeringState steeringAction, SpeedState speedAction);
 	void handleKeyboardEvent(const sf::Event& event);
 	ecs::Vec3f position() const;
 
+	// draws a ship without needing the live object, e.g. from a world snapshot
+	static void drawHull(sf::RenderTarget& target, const ecs::Vec3f position, const float heading, const sf::Color color);
 	static sf::Vector2f rotate2D(sf::Vector2f point, float angle, sf::Vector2f pivot);
 
 	ecs::Vec3f mPosition;
@@ -34,6 +30,4 @@ public:
 	float mAcceleration;
 	float mHeading;
 	float mSpeed{ 0.0f };
-
-	std::unique_ptr<IAgent> mAgent;
 };
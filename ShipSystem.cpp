@@ -0,0 +1,195 @@
+#include <ShipSystem.h>
+#include <JobSystem.h>
+#include <Simd.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace GameJamAsteroids {
+	namespace {
+		constexpr float accelerationDampening = 0.9f;
+		constexpr float steeringAmount = 0.1f;
+		constexpr float thrustAmount = 0.000001f;
+		constexpr float maxAcceleration = 0.001f;
+
+		// ships handed to one task
+		constexpr size_t ChunkSize = 1024;
+
+		struct Bounds {
+			float width;
+			float height;
+			float dt;
+		};
+
+		struct Ships {
+			float* px;
+			float* py;
+			float* vx;
+			float* vy;
+			float* heading;
+			float* speed;
+			float* acceleration;
+		};
+
+		void integrateScalar(const Bounds& bounds, const Ships& s, const float* turn, const float* thrust, const size_t begin, const size_t end) {
+			const float maxX = bounds.width - 1.0f;
+			const float maxY = bounds.height - 1.0f;
+			for (size_t k = begin; k < end; ++k) {
+				const float heading = s.heading[k] + turn[k - begin];
+				float acceleration = s.acceleration[k] * accelerationDampening + thrust[k - begin];
+				acceleration = std::min(maxAcceleration, std::max(-maxAcceleration, acceleration));
+				float speed = s.speed[k] + acceleration * bounds.dt;
+				if (speed < 0.0f) {
+					speed = 0.0f;
+					acceleration = 0.0f;
+				}
+
+				const float vx = speed * std::cos(heading);
+				const float vy = speed * std::sin(heading);
+				const float x = s.px[k] + bounds.dt * vx;
+				const float y = s.py[k] + bounds.dt * vy;
+				s.px[k] = x < bounds.width ? (x > 0.0f ? x : maxX) : 0.0f;
+				s.py[k] = y < bounds.height ? (y > 0.0f ? y : maxY) : 0.0f;
+				s.vx[k] = vx;
+				s.vy[k] = vy;
+				s.heading[k] = heading;
+				s.speed[k] = speed;
+				s.acceleration[k] = acceleration;
+			}
+		}
+
+		void integrateSimd(const Bounds& bounds, const Ships& s, const float* turn, const float* thrust, const size_t begin, const size_t end) {
+			const auto zero = simd::zero();
+			const auto dampening = simd::set1(accelerationDampening);
+			const auto minAcceleration = simd::set1(-maxAcceleration);
+			const auto maxAccelerationV = simd::set1(maxAcceleration);
+			const auto width = simd::set1(bounds.width);
+			const auto height = simd::set1(bounds.height);
+			const auto maxX = simd::set1(bounds.width - 1.0f);
+			const auto maxY = simd::set1(bounds.height - 1.0f);
+			const auto dt = simd::set1(bounds.dt);
+
+			size_t k = begin;
+			for (; k + simd::Width <= end; k += simd::Width) {
+				const auto heading = simd::add(simd::load(s.heading + k), simd::load(turn + k - begin));
+				auto acceleration = simd::add(simd::mul(simd::load(s.acceleration + k), dampening), simd::load(thrust + k - begin));
+				acceleration = simd::min(maxAccelerationV, simd::max(minAcceleration, acceleration));
+				auto speed = simd::add(simd::load(s.speed + k), simd::mul(acceleration, dt));
+				const auto stopped = simd::less(speed, zero);
+				speed = simd::select(stopped, zero, speed);
+				acceleration = simd::select(stopped, zero, acceleration);
+
+				simd::Float sine, cosine;
+				simd::sinCos(heading, sine, cosine);
+				const auto vx = simd::mul(speed, cosine);
+				const auto vy = simd::mul(speed, sine);
+				const auto x = simd::add(simd::load(s.px + k), simd::mul(dt, vx));
+				const auto y = simd::add(simd::load(s.py + k), simd::mul(dt, vy));
+
+				simd::store(s.px + k, simd::select(simd::less(x, width), simd::select(simd::greater(x, zero), x, maxX), zero));
+				simd::store(s.py + k, simd::select(simd::less(y, height), simd::select(simd::greater(y, zero), y, maxY), zero));
+				simd::store(s.vx + k, vx);
+				simd::store(s.vy + k, vy);
+				simd::store(s.heading + k, heading);
+				simd::store(s.speed + k, speed);
+				simd::store(s.acceleration + k, acceleration);
+			}
+			integrateScalar(bounds, s, turn + (k - begin), thrust + (k - begin), k, end);
+		}
+	}
+
+	ecs::EntityRange spawnShips(ECS& ecs, const std::vector<ecs::Vec2f>& positions, const std::vector<ecs::Color>& colors) {
+		return ecs.createEntities<ecs::EntityType::Ship>(positions.size(),
+			ecs::column<ecs::ComponentType::Position>([&](const ecs::Vec2Pointer out, const size_t first, const size_t count) {
+				for (size_t k = 0; k < count; ++k) {
+					out[k] = positions[first + k];
+				}
+			}),
+			ecs::column<ecs::ComponentType::Color>([&](ecs::Color* out, const size_t first, const size_t count) {
+				std::copy_n(colors.begin() + first, count, out);
+			}));
+	}
+
+	size_t shipCount(const ECS& ecs) {
+		return ecs.entities<ecs::EntityType::Ship>().size();
+	}
+
+	ShipObservations observeShips(const ECS& ecs, const size_t width, const size_t height) {
+		const auto& positions = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+		ShipObservations observations;
+		observations.count = positions.size();
+		observations.x = positions.x.data();
+		observations.y = positions.y.data();
+		observations.heading = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Heading>().data();
+		observations.speed = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Speed>().data();
+		const auto& velocities = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Velocity>();
+		observations.vx = velocities.x.data();
+		observations.vy = velocities.y.data();
+		observations.width = static_cast<float>(width);
+		observations.height = static_cast<float>(height);
+		return observations;
+	}
+
+	void integrateShips(const size_t width, const size_t height, ECS& ecs, const ShipActions& actions, const float dt, const Integrator integrator) {
+		auto& positions = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+		auto& velocities = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Velocity>();
+		const Bounds bounds{ static_cast<float>(width), static_cast<float>(height), dt };
+		const Ships ships{
+			positions.x.data(), positions.y.data(), velocities.x.data(), velocities.y.data(),
+			ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Heading>().data(),
+			ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Speed>().data(),
+			ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Acceleration>().data()
+		};
+		const bool vectorized = integrator == Integrator::Simd;
+
+		JobSystem::instance().parallelFor(positions.size(), ChunkSize, [&](const size_t begin, const size_t end) {
+			// actions as heading and acceleration deltas
+			float turn[ChunkSize];
+			float thrust[ChunkSize];
+			for (size_t k = begin; k < end; ++k) {
+				const auto steering = actions.steering[k];
+				const auto speed = actions.speed[k];
+				turn[k - begin] = steering == SteeringState::Left ? -steeringAmount : (steering == SteeringState::Right ? steeringAmount : 0.0f);
+				thrust[k - begin] = speed == SpeedState::Increase ? thrustAmount : (speed == SpeedState::Decrease ? -thrustAmount : 0.0f);
+			}
+
+			if (vectorized) {
+				integrateSimd(bounds, ships, turn, thrust, begin, end);
+			}
+			else {
+				integrateScalar(bounds, ships, turn, thrust, begin, end);
+			}
+		});
+	}
+
+	float shipIntegratorDeviation(const size_t width, const size_t height, const ECS& ecs, const uint64_t seed, const float dt, const size_t ticks) {
+		ECS scalarShips = ecs, simdShips = ecs;
+		MarkovPolicy policy(seed);
+		ShipActions actions;
+		const auto count = shipCount(ecs);
+		policy.resize(count);
+		actions.resize(count);
+
+		for (size_t tick = 0; tick < ticks; ++tick) {
+			// the Markov policy ignores its observations, so both fleets get the same actions
+			const auto observations = observeShips(scalarShips, width, height);
+			policy.prepare(observations);
+			policy.act(observations, actions, 0, count);
+			integrateShips(width, height, scalarShips, actions, dt, Integrator::Scalar);
+			integrateShips(width, height, simdShips, actions, dt, Integrator::Simd);
+		}
+
+		const auto& scalarPositions = scalarShips.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+		const auto& simdPositions = simdShips.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+		const auto w = static_cast<float>(width);
+		const auto h = static_cast<float>(height);
+		float deviation = 0.0f;
+		for (size_t k = 0; k < count; ++k) {
+			const float dx = std::abs(scalarPositions.x[k] - simdPositions.x[k]);
+			const float dy = std::abs(scalarPositions.y[k] - simdPositions.y[k]);
+			deviation = std::max(deviation, std::min(dx, w - dx));
+			deviation = std::max(deviation, std::min(dy, h - dy));
+		}
+		return deviation;
+	}
+}
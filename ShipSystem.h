@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Agent.h>
+#include <ECS.h>
+#include <Simulation.h>
+#include <vector>
+
+namespace GameJamAsteroids {
+	// Ships are EntityType::Ship entities with Position, Velocity, Color, Heading, Speed and
+	// Acceleration columns. Spawns one ship per position, all at rest and heading along +x.
+	ecs::EntityRange spawnShips(ECS& ecs, const std::vector<ecs::Vec2f>& positions, const std::vector<ecs::Color>& colors);
+	size_t shipCount(const ECS& ecs);
+	ShipObservations observeShips(const ECS& ecs, const size_t width, const size_t height);
+
+	// Applies every ship's actions and moves it one step, wrapping at the world edges. The
+	// Simd integrator runs the whole fleet through simd::sinCos and matches Scalar within float
+	// tolerance.
+	void integrateShips(const size_t width, const size_t height, ECS& ecs, const ShipActions& actions, const float dt, const Integrator integrator = Integrator::Simd);
+
+	// Flies copies of the ships with both integrators under the same MarkovPolicy and returns the
+	// largest position difference, measured across the wrap, after the given number of ticks.
+	float shipIntegratorDeviation(const size_t width, const size_t height, const ECS& ecs, const uint64_t seed, const float dt, const size_t ticks);
+}
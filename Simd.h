@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GJA_SSE2 1
+#endif
+
+// Thin float-pack wrapper so kernels are written once: AVX (8 lanes), SSE2 (4 lanes) or plain
+// float (1 lane) depending on what the build targets. Loads and stores are unaligned.
+namespace simd {
+
+#if defined(__AVX__)
+constexpr size_t Width = 8;
+using Float = __m256;
+using Mask = __m256;
+
+inline const char* name() { return "avx"; }
+inline Float load(const float* p) { return _mm256_loadu_ps(p); }
+inline void store(float* p, const Float v) { _mm256_storeu_ps(p, v); }
+inline Float set1(const float v) { return _mm256_set1_ps(v); }
+inline Float zero() { return _mm256_setzero_ps(); }
+inline Float add(const Float a, const Float b) { return _mm256_add_ps(a, b); }
+inline Float sub(const Float a, const Float b) { return _mm256_sub_ps(a, b); }
+inline Float mul(const Float a, const Float b) { return _mm256_mul_ps(a, b); }
+inline Float div(const Float a, const Float b) { return _mm256_div_ps(a, b); }
+inline Float min(const Float a, const Float b) { return _mm256_min_ps(a, b); }
+inline Float max(const Float a, const Float b) { return _mm256_max_ps(a, b); }
+inline Mask less(const Float a, const Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+inline Mask greater(const Float a, const Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline Float select(const Mask m, const Float a, const Float b) { return _mm256_blendv_ps(b, a, m); }
+inline Float floor(const Float v) { return _mm256_floor_ps(v); }
+#elif defined(GJA_SSE2)
+constexpr size_t Width = 4;
+using Float = __m128;
+using Mask = __m128;
+
+inline const char* name() { return "sse2"; }
+inline Float load(const float* p) { return _mm_loadu_ps(p); }
+inline void store(float* p, const Float v) { _mm_storeu_ps(p, v); }
+inline Float set1(const float v) { return _mm_set1_ps(v); }
+inline Float zero() { return _mm_setzero_ps(); }
+inline Float add(const Float a, const Float b) { return _mm_add_ps(a, b); }
+inline Float sub(const Float a, const Float b) { return _mm_sub_ps(a, b); }
+inline Float mul(const Float a, const Float b) { return _mm_mul_ps(a, b); }
+inline Float div(const Float a, const Float b) { return _mm_div_ps(a, b); }
+inline Float min(const Float a, const Float b) { return _mm_min_ps(a, b); }
+inline Float max(const Float a, const Float b) { return _mm_max_ps(a, b); }
+inline Mask less(const Float a, const Float b) { return _mm_cmplt_ps(a, b); }
+inline Mask greater(const Float a, const Float b) { return _mm_cmpgt_ps(a, b); }
+inline Float select(const Mask m, const Float a, const Float b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+// truncate, then step down where that rounded up (negative inputs)
+inline Float floor(const Float v) {
+	const Float t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+}
+#else
+constexpr size_t Width = 1;
+using Float = float;
+using Mask = bool;
+
+inline const char* name() { return "scalar fallback"; }
+inline Float load(const float* p) { return *p; }
+inline void store(float* p, const Float v) { *p = v; }
+inline Float set1(const float v) { return v; }
+inline Float zero() { return 0.0f; }
+inline Float add(const Float a, const Float b) { return a + b; }
+inline Float sub(const Float a, const Float b) { return a - b; }
+inline Float mul(const Float a, const Float b) { return a * b; }
+inline Float div(const Float a, const Float b) { return a / b; }
+inline Float min(const Float a, const Float b) { return a < b ? a : b; }
+inline Float max(const Float a, const Float b) { return a > b ? a : b; }
+inline Mask less(const Float a, const Float b) { return a < b; }
+inline Mask greater(const Float a, const Float b) { return a > b; }
+inline Float select(const Mask m, const Float a, const Float b) { return m ? a : b; }
+inline Float floor(const Float v) { return std::floor(v); }
+#endif
+
+// sin and cos of v at once, within a few ulp of std::sin/std::cos for |v| up to about 1e5.
+// Reduces to [-pi/4, pi/4] around the nearest multiple of pi/2, evaluates the Cephes sinf/cosf
+// polynomials and swaps or negates them by quadrant.
+inline void sinCos(const Float v, Float& sine, Float& cosine) {
+	const Float k = floor(add(mul(v, set1(0.636619772f)), set1(0.5f)));
+	// pi/2 in three parts so k * part stays exact
+	Float r = sub(v, mul(k, set1(1.5703125f)));
+	r = sub(r, mul(k, set1(4.837512969970703125e-4f)));
+	r = sub(r, mul(k, set1(7.54978995489188216e-8f)));
+	const Float r2 = mul(r, r);
+
+	Float s = add(mul(set1(-1.9515295891e-4f), r2), set1(8.3321608736e-3f));
+	s = add(mul(s, r2), set1(-1.6666654611e-1f));
+	s = add(mul(mul(s, r2), r), r);
+	Float c = add(mul(set1(2.443315711809948e-5f), r2), set1(-1.388731625493765e-3f));
+	c = add(mul(c, r2), set1(4.166664568298827e-2f));
+	c = add(sub(mul(mul(c, r2), r2), mul(set1(0.5f), r2)), set1(1.0f));
+
+	// quadrant 0..3 gives (sin, cos) = (s, c), (c, -s), (-s, -c), (-c, s)
+	const Float quadrant = sub(k, mul(floor(mul(k, set1(0.25f))), set1(4.0f)));
+	const Mask odd = greater(sub(quadrant, mul(floor(mul(quadrant, set1(0.5f))), set1(2.0f))), set1(0.5f));
+	const Float fromCenter = sub(quadrant, set1(1.5f));
+	const Float one = set1(1.0f);
+	const Float minusOne = set1(-1.0f);
+	sine = mul(select(odd, c, s), select(greater(quadrant, set1(1.5f)), minusOne, one));
+	cosine = mul(select(odd, s, c), select(less(mul(fromCenter, fromCenter), one), minusOne, one));
+}
+
+}
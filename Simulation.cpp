@@ -0,0 +1,161 @@
+#include <Simulation.h>
+#include <JobSystem.h>
+#include <Simd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace GameJamAsteroids {
+	namespace {
+		constexpr float friction = 0.9975f;
+		constexpr float gravity = 0.025f;
+		constexpr float shipGravityFactor = 0.02f;
+
+		// particles handed to one task
+		constexpr size_t ChunkSize = 4096;
+
+		struct Bounds {
+			float width;
+			float height;
+			float dt;
+		};
+
+		struct Particles {
+			float* px;
+			float* py;
+			float* vx;
+			float* vy;
+		};
+
+		void integrateScalar(const Bounds& bounds, const Particles& p, const float* fx, const float* fy, const size_t begin, const size_t end) {
+			const float maxX = bounds.width - 1.0f;
+			const float maxY = bounds.height - 1.0f;
+			for (size_t k = begin; k < end; ++k) {
+				const float vx = p.vx[k] * friction + fx[k - begin];
+				const float vy = p.vy[k] * friction + fy[k - begin];
+
+				const float x = p.px[k] + bounds.dt * vx;
+				const float y = p.py[k] + bounds.dt * vy;
+				p.px[k] = x < bounds.width ? (x > 0.0f ? x : maxX) : 0.0f;
+				p.py[k] = y < bounds.height ? (y > 0.0f ? y : maxY) : 0.0f;
+				p.vx[k] = vx;
+				p.vy[k] = vy;
+			}
+		}
+
+		void integrateSimd(const Bounds& bounds, const Particles& p, const float* fx, const float* fy, const size_t begin, const size_t end) {
+			const auto zero = simd::zero();
+			const auto vFriction = simd::set1(friction);
+			const auto width = simd::set1(bounds.width);
+			const auto height = simd::set1(bounds.height);
+			const auto maxX = simd::set1(bounds.width - 1.0f);
+			const auto maxY = simd::set1(bounds.height - 1.0f);
+			const auto dt = simd::set1(bounds.dt);
+
+			size_t k = begin;
+			for (; k + simd::Width <= end; k += simd::Width) {
+				const auto vx = simd::add(simd::mul(simd::load(p.vx + k), vFriction), simd::load(fx + k - begin));
+				const auto vy = simd::add(simd::mul(simd::load(p.vy + k), vFriction), simd::load(fy + k - begin));
+
+				const auto x = simd::add(simd::load(p.px + k), simd::mul(dt, vx));
+				const auto y = simd::add(simd::load(p.py + k), simd::mul(dt, vy));
+
+				// x < width ? (x > 0 ? x : width - 1) : 0
+				simd::store(p.px + k, simd::select(simd::less(x, width), simd::select(simd::greater(x, zero), x, maxX), zero));
+				simd::store(p.py + k, simd::select(simd::less(y, height), simd::select(simd::greater(y, zero), y, maxY), zero));
+				simd::store(p.vx + k, vx);
+				simd::store(p.vy + k, vy);
+			}
+			integrateScalar(bounds, p, fx + (k - begin), fy + (k - begin), k, end);
+		}
+	}
+
+	std::vector<sf::Vector3f> createWells(const size_t width, const size_t height) {
+		// create some gravity wells, z is the well weight
+		const float dx = 1.0f, dy = 1.0f;
+		const sf::Vector3f refPoint{ static_cast<float>(width / 2), static_cast<float>(height / 2), 1.0f };
+		std::vector<sf::Vector3f> wells = { refPoint };
+		for (int i = 0; i < 0; ++i) {
+			wells.push_back(refPoint + sf::Vector3f{ -dx * i, dy * i, 1.0f });
+			wells.push_back(refPoint + sf::Vector3f{ dx * i, dy * i, 1.0f });
+		}
+		return wells;
+	}
+
+	void buildForceField(ForceField& field, const std::vector<sf::Vector3f>& wells, const ecs::Vec2Column& shipPositions, const size_t width, const size_t height) {
+		field.clear();
+		for (const auto& well : wells) {
+			field.addSource(well.x, well.y, -gravity * well.z);
+		}
+		for (size_t i = 0; i < shipPositions.size(); ++i) {
+			field.addSource(shipPositions.x[i], shipPositions.y[i], shipGravityFactor);
+		}
+		field.prepare(width, height);
+	}
+
+	const char* integratorName(const Integrator integrator) {
+		switch (integrator) {
+		case Integrator::Scalar:
+			return "scalar";
+		case Integrator::Simd:
+			return simd::name();
+		}
+		return "unknown";
+	}
+
+	bool parseIntegrator(const char* name, Integrator& integrator) {
+		if (std::strcmp(name, "scalar") == 0) {
+			integrator = Integrator::Scalar;
+			return true;
+		}
+		if (std::strcmp(name, "simd") == 0) {
+			integrator = Integrator::Simd;
+			return true;
+		}
+		return false;
+	}
+
+	void simulation(const size_t width, const size_t height, ecs::Vec2Column& positions, ecs::Vec2Column& velocities, const ForceField& field, const float dt, const Integrator integrator) {
+		const Bounds bounds{ static_cast<float>(width), static_cast<float>(height), dt };
+		const Particles particles{ positions.x.data(), positions.y.data(), velocities.x.data(), velocities.y.data() };
+		const bool vectorized = integrator == Integrator::Simd;
+
+		JobSystem::instance().parallelFor(positions.size(), ChunkSize, [&](const size_t begin, const size_t end) {
+			float fx[ChunkSize];
+			float fy[ChunkSize];
+			std::fill_n(fx, end - begin, 0.0f);
+			std::fill_n(fy, end - begin, 0.0f);
+			field.accumulate(particles.px, particles.py, fx, fy, begin, end, vectorized);
+
+			if (vectorized) {
+				integrateSimd(bounds, particles, fx, fy, begin, end);
+			}
+			else {
+				integrateScalar(bounds, particles, fx, fy, begin, end);
+			}
+		});
+	}
+
+	float integratorDeviation(const size_t width, const size_t height, const ecs::Vec2Column& positions, const ecs::Vec2Column& velocities, const ForceField& field, const float dt, const size_t ticks) {
+		ecs::Vec2Column scalarPositions = positions, scalarVelocities = velocities;
+		ecs::Vec2Column simdPositions = positions, simdVelocities = velocities;
+
+		float deviation = 0.0f;
+		for (size_t tick = 0; tick < ticks; ++tick) {
+			simulation(width, height, scalarPositions, scalarVelocities, field, dt, Integrator::Scalar);
+			simulation(width, height, simdPositions, simdVelocities, field, dt, Integrator::Simd);
+		}
+		// distance across the wrap, a particle leaving one edge comes back at the other
+		const auto w = static_cast<float>(width);
+		const auto h = static_cast<float>(height);
+		for (size_t k = 0; k < positions.size(); ++k) {
+			const float dx = std::abs(scalarPositions.x[k] - simdPositions.x[k]);
+			const float dy = std::abs(scalarPositions.y[k] - simdPositions.y[k]);
+			deviation = std::max(deviation, std::min(dx, w - dx));
+			deviation = std::max(deviation, std::min(dy, h - dy));
+		}
+		return deviation;
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <EcsColumns.h>
+#include <EcsTypes.h>
+#include <ForceField.h>
+#include <vector>
+
+namespace GameJamAsteroids {
+	// Particle integrator backend. Simd uses AVX or SSE2 when the build targets them (see Simd.h);
+	// both produce the same results within float tolerance.
+	enum class Integrator {
+		Scalar,
+		Simd
+	};
+
+	const char* integratorName(const Integrator integrator);
+	bool parseIntegrator(const char* name, Integrator& integrator);
+
+	std::vector<sf::Vector3f> createWells(const size_t width, const size_t height);
+	// Refills the field with the gravity wells (pulling) and every ship (pushing) for this tick.
+	void buildForceField(ForceField& field, const std::vector<sf::Vector3f>& wells, const ecs::Vec2Column& shipPositions, const size_t width, const size_t height);
+
+	void simulation(const size_t width, const size_t height, ecs::Vec2Column& positions, ecs::Vec2Column& velocities, const ForceField& field, const float dt, const Integrator integrator = Integrator::Simd);
+
+	// Steps copies of the given particles with both integrators and returns the largest absolute
+	// position difference seen after the given number of ticks.
+	float integratorDeviation(const size_t width, const size_t height, const ecs::Vec2Column& positions, const ecs::Vec2Column& velocities, const ForceField& field, const float dt, const size_t ticks);
+}
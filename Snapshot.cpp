@@ -0,0 +1,23 @@
+#include <Snapshot.h>
+#include <World.h>
+
+void captureSnapshot(const World& world, const size_t tick, WorldSnapshot& snapshot) {
+	snapshot.tick = tick;
+	snapshot.width = static_cast<float>(world.width);
+	snapshot.height = static_cast<float>(world.height);
+
+	const auto& ecs = world.ecs;
+	const auto& shipPositions = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Position>();
+	const auto& shipHeadings = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Heading>();
+	const auto& shipColors = ecs.data<ecs::EntityType::Ship, ecs::ComponentType::Color>();
+	snapshot.ships.resize(shipPositions.size());
+	for (size_t i = 0; i < shipPositions.size(); ++i) {
+		snapshot.ships[i] = { { shipPositions.x[i], shipPositions.y[i], 0.0f }, shipHeadings[i], shipColors[i] };
+	}
+
+	snapshot.particleHandles = ecs.entities<ecs::EntityType::Square>();
+	snapshot.particlePositions = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Position>();
+	snapshot.particleSizes = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Size>();
+	snapshot.particleColors = ecs.data<ecs::EntityType::Square, ecs::ComponentType::Color>();
+	snapshot.particleAngularVelocities = ecs.data<ecs::EntityType::Square, ecs::ComponentType::AngularVelocity>();
+}
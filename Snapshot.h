@@ -0,0 +1,37 @@
+#pragma once
+
+#include <EcsColumns.h>
+#include <EcsTypes.h>
+#include <cmath>
+#include <vector>
+
+struct World;
+
+struct ShipSnapshot {
+	ecs::Vec3f position;
+	float heading{ 0.0f };
+	sf::Color color;
+};
+
+// Immutable copy of everything the renderer reads for one tick, so the simulation can write the
+// next tick while this one is drawn.
+struct WorldSnapshot {
+	size_t tick{ 0 };
+	float width{ 0.0f };
+	float height{ 0.0f };
+	std::vector<ShipSnapshot> ships;
+	// tells a particle from the one that took its index after a retire or spawn
+	std::vector<ecs::EntityHandle> particleHandles;
+	ecs::Vec2Column particlePositions;
+	std::vector<ecs::Size> particleSizes;
+	std::vector<ecs::Color> particleColors;
+	std::vector<ecs::AngularVelocity> particleAngularVelocities;
+};
+
+// Blends from a to b, but snaps to b when the step crossed the world edge.
+inline float lerpWrapped(const float a, const float b, const float alpha, const float size) {
+	return std::abs(b - a) < 0.5f * size ? a + (b - a) * alpha : b;
+}
+
+// Overwrites snapshot with the current world state, reusing its storage.
+void captureSnapshot(const World& world, const size_t tick, WorldSnapshot& snapshot);
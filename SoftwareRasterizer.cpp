@@ -0,0 +1,375 @@
+#include <SoftwareRasterizer.h>
+#include <JobSystem.h>
+#include <Profiler.h>
+
+#include <SFML/Graphics/Image.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+
+namespace {
+	// vertex positions in 1/Subpixel pixels
+	constexpr int64_t Subpixel = 256;
+
+	struct FixedPoint {
+		int64_t x;
+		int64_t y;
+	};
+
+	FixedPoint toFixed(const sf::Vector2f v) {
+		return { std::llround(v.x * Subpixel), std::llround(v.y * Subpixel) };
+	}
+
+	// twice the signed area of a, b, p; exact
+	int64_t edge(const FixedPoint a, const FixedPoint b, const FixedPoint p) {
+		return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+	}
+
+	bool endsWith(const std::string& text, const std::string& suffix) {
+		return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+
+	bool readPpmHeaderValue(std::istream& in, unsigned int& value) {
+		// skip whitespace and comments
+		for (;;) {
+			const int c = in.peek();
+			if (c == '#') {
+				std::string comment;
+				std::getline(in, comment);
+			}
+			else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+				in.get();
+			}
+			else {
+				break;
+			}
+		}
+		return static_cast<bool>(in >> value);
+	}
+
+	bool loadPpm(const std::string& path, unsigned int& width, unsigned int& height, std::vector<sf::Uint8>& pixels) {
+		std::ifstream in(path, std::ios::binary);
+		std::string magic;
+		unsigned int maxValue = 0;
+		if (!(in >> magic) || magic != "P6" || !readPpmHeaderValue(in, width) || !readPpmHeaderValue(in, height) || !readPpmHeaderValue(in, maxValue) || maxValue != 255) {
+			return false;
+		}
+		in.get();
+
+		std::vector<char> rgb(static_cast<size_t>(width) * height * 3);
+		if (!in.read(rgb.data(), rgb.size())) {
+			return false;
+		}
+		pixels.resize(static_cast<size_t>(width) * height * 4);
+		for (size_t i = 0, n = static_cast<size_t>(width) * height; i < n; ++i) {
+			pixels[4 * i + 0] = static_cast<sf::Uint8>(rgb[3 * i + 0]);
+			pixels[4 * i + 1] = static_cast<sf::Uint8>(rgb[3 * i + 1]);
+			pixels[4 * i + 2] = static_cast<sf::Uint8>(rgb[3 * i + 2]);
+			pixels[4 * i + 3] = 255;
+		}
+		return true;
+	}
+}
+
+SoftwareRasterizer::SoftwareRasterizer(const unsigned int width, const unsigned int height)
+	: mWidth{ width }
+	, mHeight{ height }
+	, mTilesX{ (width + TileSize - 1) / TileSize }
+	, mTilesY{ (height + TileSize - 1) / TileSize }
+	, mView{ sf::FloatRect(0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)) }
+	, mPixels(static_cast<size_t>(width) * height * 4, 0)
+	, mBinStart(static_cast<size_t>(mTilesX) * mTilesY + 1, 0) {
+}
+
+void SoftwareRasterizer::clear(const sf::Color color) {
+	mPrimitives.clear();
+	for (size_t i = 0; i < mPixels.size(); i += 4) {
+		mPixels[i + 0] = color.r;
+		mPixels[i + 1] = color.g;
+		mPixels[i + 2] = color.b;
+		mPixels[i + 3] = color.a;
+	}
+}
+
+void SoftwareRasterizer::draw(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type) {
+	switch (type) {
+	case sf::Points:
+		for (size_t i = 0; i < count; ++i) {
+			addPoint(vertices[i]);
+		}
+		break;
+	case sf::Triangles:
+		for (size_t i = 0; i + 2 < count; i += 3) {
+			addTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+		}
+		break;
+	case sf::TriangleStrip:
+		for (size_t i = 2; i < count; ++i) {
+			addTriangle(vertices[i - 2], vertices[i - 1], vertices[i]);
+		}
+		break;
+	case sf::TriangleFan:
+		for (size_t i = 2; i < count; ++i) {
+			addTriangle(vertices[0], vertices[i - 1], vertices[i]);
+		}
+		break;
+	case sf::Quads:
+		for (size_t i = 0; i + 3 < count; i += 4) {
+			addTriangle(vertices[i], vertices[i + 1], vertices[i + 2]);
+			addTriangle(vertices[i], vertices[i + 2], vertices[i + 3]);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+void SoftwareRasterizer::display() {
+	ProfileScope scope("raster");
+
+	// bin every primitive into the tiles its bounding box touches: count per tile, then place them
+	// in submission order into one array
+	std::fill(mBinStart.begin(), mBinStart.end(), 0);
+	unsigned int firstX, lastX, firstY, lastY;
+	for (const auto& primitive : mPrimitives) {
+		if (tilesOf(primitive, firstX, lastX, firstY, lastY)) {
+			for (unsigned int y = firstY; y <= lastY; ++y) {
+				for (unsigned int x = firstX; x <= lastX; ++x) {
+					++mBinStart[y * mTilesX + x + 1];
+				}
+			}
+		}
+	}
+	for (size_t tile = 1; tile < mBinStart.size(); ++tile) {
+		mBinStart[tile] += mBinStart[tile - 1];
+	}
+	const size_t binned = mBinStart.back();
+	if (binned > mBinned.capacity()) {
+		// with room to spare, so frames that bin a few more primitives do not allocate again
+		mBinned.reserve(binned + binned / 4);
+	}
+	mBinned.resize(binned);
+	for (unsigned int i = 0; i < mPrimitives.size(); ++i) {
+		if (tilesOf(mPrimitives[i], firstX, lastX, firstY, lastY)) {
+			for (unsigned int y = firstY; y <= lastY; ++y) {
+				for (unsigned int x = firstX; x <= lastX; ++x) {
+					// the tile's start doubles as its cursor and ends up at the next tile's start
+					mBinned[mBinStart[y * mTilesX + x]++] = i;
+				}
+			}
+		}
+	}
+	std::copy_backward(mBinStart.begin(), mBinStart.end() - 1, mBinStart.end());
+	mBinStart[0] = 0;
+
+	// tiles own disjoint pixels, so they shade without synchronization
+	JobSystem::instance().parallelFor(mBinStart.size() - 1, 1, [this](const size_t begin, const size_t end) {
+		for (size_t tile = begin; tile < end; ++tile) {
+			rasterizeTile(tile);
+		}
+	});
+	mPrimitives.clear();
+}
+
+bool SoftwareRasterizer::tilesOf(const Primitive& primitive, unsigned int& firstX, unsigned int& lastX, unsigned int& firstY, unsigned int& lastY) const {
+	const float maxX = static_cast<float>(mWidth - 1);
+	const float maxY = static_cast<float>(mHeight - 1);
+	float left = primitive.position[0].x;
+	float right = left;
+	float top = primitive.position[0].y;
+	float bottom = top;
+	for (unsigned char v = 1; v < primitive.vertexCount; ++v) {
+		left = std::min(left, primitive.position[v].x);
+		right = std::max(right, primitive.position[v].x);
+		top = std::min(top, primitive.position[v].y);
+		bottom = std::max(bottom, primitive.position[v].y);
+	}
+	if (right < 0.0f || bottom < 0.0f || left > maxX + 1.0f || top > maxY + 1.0f) {
+		return false;
+	}
+
+	firstX = static_cast<unsigned int>(std::max(left, 0.0f)) / TileSize;
+	lastX = static_cast<unsigned int>(std::min(right, maxX)) / TileSize;
+	firstY = static_cast<unsigned int>(std::max(top, 0.0f)) / TileSize;
+	lastY = static_cast<unsigned int>(std::min(bottom, maxY)) / TileSize;
+	return true;
+}
+
+void SoftwareRasterizer::setView(const sf::View& view) {
+	mView = view;
+}
+
+sf::View SoftwareRasterizer::getView() const {
+	return mView;
+}
+
+sf::Vector2u SoftwareRasterizer::getSize() const {
+	return { mWidth, mHeight };
+}
+
+bool SoftwareRasterizer::saveToFile(const std::string& path) const {
+	if (endsWith(path, ".ppm")) {
+		std::ofstream out(path, std::ios::binary);
+		out << "P6\n" << mWidth << " " << mHeight << "\n255\n";
+		for (size_t i = 0; i < mPixels.size(); i += 4) {
+			out.write(reinterpret_cast<const char*>(&mPixels[i]), 3);
+		}
+		return static_cast<bool>(out);
+	}
+
+	sf::Image image;
+	image.create(mWidth, mHeight, mPixels.data());
+	return image.saveToFile(path);
+}
+
+void SoftwareRasterizer::addTriangle(const sf::Vertex& a, const sf::Vertex& b, const sf::Vertex& c) {
+	mPrimitives.push_back({ { toPixels(a.position), toPixels(b.position), toPixels(c.position) }, { a.color, b.color, c.color }, 3 });
+}
+
+void SoftwareRasterizer::addPoint(const sf::Vertex& a) {
+	mPrimitives.push_back({ { toPixels(a.position) }, { a.color }, 1 });
+}
+
+sf::Vector2f SoftwareRasterizer::toPixels(const sf::Vector2f position) const {
+	const auto center = mView.getCenter();
+	const auto size = mView.getSize();
+	return { (position.x - center.x + 0.5f * size.x) * mWidth / size.x, (position.y - center.y + 0.5f * size.y) * mHeight / size.y };
+}
+
+void SoftwareRasterizer::rasterizeTile(const size_t tile) {
+	const int minX = static_cast<int>((tile % mTilesX) * TileSize);
+	const int minY = static_cast<int>((tile / mTilesX) * TileSize);
+	const int maxX = std::min(minX + static_cast<int>(TileSize), static_cast<int>(mWidth)) - 1;
+	const int maxY = std::min(minY + static_cast<int>(TileSize), static_cast<int>(mHeight)) - 1;
+
+	for (auto n = mBinStart[tile]; n < mBinStart[tile + 1]; ++n) {
+		const auto& primitive = mPrimitives[mBinned[n]];
+		if (primitive.vertexCount == 1) {
+			const int x = static_cast<int>(std::floor(primitive.position[0].x));
+			const int y = static_cast<int>(std::floor(primitive.position[0].y));
+			if (x >= minX && x <= maxX && y >= minY && y <= maxY) {
+				blend(x, y, primitive.color[0]);
+			}
+		}
+		else {
+			shadeTriangle(primitive, minX, minY, maxX, maxY);
+		}
+	}
+}
+
+void SoftwareRasterizer::shadeTriangle(const Primitive& triangle, const int minX, const int minY, const int maxX, const int maxY) {
+	// Edges are evaluated exactly on a 1/256 pixel grid, so two triangles sharing an edge agree on
+	// every pixel center lying on it, and the top-left rule gives each such pixel to one of them.
+	const FixedPoint p[3] = { toFixed(triangle.position[0]), toFixed(triangle.position[1]), toFixed(triangle.position[2]) };
+	const auto& c = triangle.color;
+	const int64_t area = edge(p[0], p[1], p[2]);
+	if (area == 0) {
+		return;
+	}
+	// inside is where all three edge functions have the sign of the area
+	const int64_t sign = area > 0 ? 1 : -1;
+	const float invArea = 1.0f / static_cast<float>(area * sign);
+	const bool flat = c[0] == c[1] && c[1] == c[2];
+
+	// pixel centers inside the triangle's bounding box and this tile
+	const auto& q = triangle.position;
+	const int left = std::max(minX, static_cast<int>(std::floor(std::min({ q[0].x, q[1].x, q[2].x }))));
+	const int right = std::min(maxX, static_cast<int>(std::ceil(std::max({ q[0].x, q[1].x, q[2].x }))));
+	const int top = std::max(minY, static_cast<int>(std::floor(std::min({ q[0].y, q[1].y, q[2].y }))));
+	const int bottom = std::min(maxY, static_cast<int>(std::ceil(std::max({ q[0].y, q[1].y, q[2].y }))));
+
+	// Edge i is opposite vertex i. A pixel center on a left edge (inside to its right) or on a top
+	// edge (horizontal, inside below it) is covered; one on any other edge is not, so those edges
+	// are biased by one unit.
+	const FixedPoint from[3] = { p[1], p[2], p[0] };
+	const FixedPoint to[3] = { p[2], p[0], p[1] };
+	int64_t stepX[3], stepY[3], bias[3];
+	for (int i = 0; i < 3; ++i) {
+		stepX[i] = (from[i].y - to[i].y) * sign;
+		stepY[i] = (to[i].x - from[i].x) * sign;
+		const bool topLeft = stepX[i] > 0 || (stepX[i] == 0 && stepY[i] > 0);
+		bias[i] = topLeft ? 0 : -1;
+	}
+
+	const FixedPoint first{ static_cast<int64_t>(left) * Subpixel + Subpixel / 2, static_cast<int64_t>(top) * Subpixel + Subpixel / 2 };
+	int64_t row[3];
+	for (int i = 0; i < 3; ++i) {
+		row[i] = edge(from[i], to[i], first) * sign + bias[i];
+	}
+	for (int y = top; y <= bottom; ++y) {
+		int64_t w0 = row[0], w1 = row[1], w2 = row[2];
+		for (int x = left; x <= right; ++x, w0 += stepX[0] * Subpixel, w1 += stepX[1] * Subpixel, w2 += stepX[2] * Subpixel) {
+			if (w0 < 0 || w1 < 0 || w2 < 0) {
+				continue;
+			}
+
+			if (flat) {
+				blend(x, y, c[0]);
+				continue;
+			}
+			// barycentric weights, without the bias
+			const float b0 = static_cast<float>(w0 - bias[0]) * invArea;
+			const float b1 = static_cast<float>(w1 - bias[1]) * invArea;
+			const float b2 = static_cast<float>(w2 - bias[2]) * invArea;
+			auto channel = [&](const sf::Uint8 a, const sf::Uint8 b, const sf::Uint8 d) {
+				return static_cast<sf::Uint8>(std::min(255.0f, b0 * a + b1 * b + b2 * d + 0.5f));
+			};
+			blend(x, y, { channel(c[0].r, c[1].r, c[2].r), channel(c[0].g, c[1].g, c[2].g), channel(c[0].b, c[1].b, c[2].b), channel(c[0].a, c[1].a, c[2].a) });
+		}
+		for (int i = 0; i < 3; ++i) {
+			row[i] += stepY[i] * Subpixel;
+		}
+	}
+}
+
+void SoftwareRasterizer::blend(const int x, const int y, const sf::Color color) {
+	// source alpha over destination, like sf::BlendAlpha
+	sf::Uint8* pixel = &mPixels[(static_cast<size_t>(y) * mWidth + x) * 4];
+	const unsigned int a = color.a;
+	const unsigned int inverse = 255 - a;
+	pixel[0] = static_cast<sf::Uint8>((color.r * a + pixel[0] * inverse + 127) / 255);
+	pixel[1] = static_cast<sf::Uint8>((color.g * a + pixel[1] * inverse + 127) / 255);
+	pixel[2] = static_cast<sf::Uint8>((color.b * a + pixel[2] * inverse + 127) / 255);
+	pixel[3] = static_cast<sf::Uint8>(a + (pixel[3] * inverse + 127) / 255);
+}
+
+bool loadImage(const std::string& path, unsigned int& width, unsigned int& height, std::vector<sf::Uint8>& pixels) {
+	if (endsWith(path, ".ppm")) {
+		return loadPpm(path, width, height, pixels);
+	}
+
+	sf::Image image;
+	if (!image.loadFromFile(path)) {
+		return false;
+	}
+	width = image.getSize().x;
+	height = image.getSize().y;
+	const auto* data = image.getPixelsPtr();
+	pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+	return true;
+}
+
+bool diffImages(const std::string& a, const std::string& b, ImageDiff& diff) {
+	unsigned int widthA = 0, heightA = 0, widthB = 0, heightB = 0;
+	std::vector<sf::Uint8> pixelsA, pixelsB;
+	if (!loadImage(a, widthA, heightA, pixelsA) || !loadImage(b, widthB, heightB, pixelsB) || widthA != widthB || heightA != heightB) {
+		return false;
+	}
+
+	diff = {};
+	diff.width = widthA;
+	diff.height = heightA;
+	for (size_t i = 0; i < pixelsA.size(); i += 4) {
+		int delta = 0;
+		for (size_t channel = 0; channel < 4; ++channel) {
+			delta = std::max(delta, std::abs(pixelsA[i + channel] - pixelsB[i + channel]));
+		}
+		if (delta > 0) {
+			++diff.differingPixels;
+			diff.maxChannelDelta = std::max(diff.maxChannelDelta, delta);
+		}
+	}
+	return true;
+}
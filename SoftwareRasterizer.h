@@ -0,0 +1,74 @@
+#pragma once
+
+#include <RenderBackend.h>
+#include <SFML/Config.hpp>
+#include <string>
+#include <vector>
+
+// CPU render target for hosts without a GPU. Draw calls are queued in pixel space and display()
+// rasterizes them: primitives are binned into square tiles and the tiles are shaded in parallel,
+// each in submission order, with the same alpha blending SFML uses by default. Triangles,
+// triangle strips and fans, quads and points are supported; lines are ignored.
+class SoftwareRasterizer : public RenderBackend {
+public:
+	static constexpr unsigned int TileSize = 64;
+
+	SoftwareRasterizer(const unsigned int width, const unsigned int height);
+
+	void clear(const sf::Color color) override;
+	void draw(const sf::Vertex* vertices, const size_t count, const sf::PrimitiveType type) override;
+	void display() override;
+
+	// area of the world mapped onto the framebuffer, the whole framebuffer by default
+	void setView(const sf::View& view);
+	sf::View getView() const override;
+	sf::Vector2u getSize() const override;
+
+	// RGBA, row by row from the top, as of the last display()
+	const std::vector<sf::Uint8>& pixels() const { return mPixels; }
+
+	// .ppm is written directly, anything else goes through sf::Image
+	bool saveToFile(const std::string& path) const;
+
+private:
+	struct Primitive {
+		sf::Vector2f position[3];
+		sf::Color color[3];
+		// 1 for a point, 3 for a triangle
+		unsigned char vertexCount;
+	};
+
+	void addTriangle(const sf::Vertex& a, const sf::Vertex& b, const sf::Vertex& c);
+	void addPoint(const sf::Vertex& a);
+	// tiles [firstX, lastX] x [firstY, lastY] under the primitive's bounding box, false when it
+	// misses the framebuffer
+	bool tilesOf(const Primitive& primitive, unsigned int& firstX, unsigned int& lastX, unsigned int& firstY, unsigned int& lastY) const;
+	sf::Vector2f toPixels(const sf::Vector2f position) const;
+	void rasterizeTile(const size_t tile);
+	void shadeTriangle(const Primitive& triangle, const int minX, const int minY, const int maxX, const int maxY);
+	void blend(const int x, const int y, const sf::Color color);
+
+	unsigned int mWidth;
+	unsigned int mHeight;
+	unsigned int mTilesX;
+	unsigned int mTilesY;
+	sf::View mView;
+	std::vector<sf::Uint8> mPixels;
+	std::vector<Primitive> mPrimitives;
+	// primitives binned by tile, tile t's in mBinned[mBinStart[t], mBinStart[t + 1])
+	std::vector<unsigned int> mBinStart;
+	std::vector<unsigned int> mBinned;
+};
+
+struct ImageDiff {
+	unsigned int width{ 0 };
+	unsigned int height{ 0 };
+	size_t differingPixels{ 0 };
+	int maxChannelDelta{ 0 };
+};
+
+// Loads a .ppm written by SoftwareRasterizer, or anything sf::Image reads, as RGBA.
+bool loadImage(const std::string& path, unsigned int& width, unsigned int& height, std::vector<sf::Uint8>& pixels);
+// Compares two images of the same size channel by channel, false when either can't be loaded or
+// the sizes differ.
+bool diffImages(const std::string& a, const std::string& b, ImageDiff& diff);
@@ -0,0 +1,154 @@
+#include <SpatialGrid.h>
+
+SpatialGrid::SpatialGrid(const float width, const float height, const float cellSize) {
+	reset(width, height, cellSize);
+}
+
+void SpatialGrid::reset(const float width, const float height, const float cellSize) {
+	mWidth = width;
+	mHeight = height;
+	// cells tile the world exactly so wrapped neighbours line up, stretched slightly if needed
+	mColumns = std::max<size_t>(1, static_cast<size_t>(width / cellSize));
+	mRows = std::max<size_t>(1, static_cast<size_t>(height / cellSize));
+	mCellWidth = width / mColumns;
+	mCellHeight = height / mRows;
+	mHead.assign(mColumns * mRows, End);
+	mCellOf.clear();
+}
+
+void SpatialGrid::clear() {
+	std::fill(mHead.begin(), mHead.end(), End);
+	mCellOf.clear();
+	mX.clear();
+	mY.clear();
+}
+
+void SpatialGrid::update(const float* xs, const float* ys, const size_t count) {
+	mNextCell.resize(count);
+	mX.assign(xs, xs + count);
+	mY.assign(ys, ys + count);
+	for (size_t i = 0; i < count; ++i) {
+		mNextCell[i] = cellIndex(xs[i], ys[i]);
+	}
+	commit(count);
+}
+
+unsigned int SpatialGrid::cellIndex(const float x, const float y) const {
+	const auto column = wrapColumn(static_cast<long long>(std::floor(x / mCellWidth)));
+	const auto row = wrapRow(static_cast<long long>(std::floor(y / mCellHeight)));
+	return static_cast<unsigned int>(row * mColumns + column);
+}
+
+size_t SpatialGrid::wrapColumn(const long long column) const {
+	const auto columns = static_cast<long long>(mColumns);
+	return static_cast<size_t>(((column % columns) + columns) % columns);
+}
+
+size_t SpatialGrid::wrapRow(const long long row) const {
+	const auto rows = static_cast<long long>(mRows);
+	return static_cast<size_t>(((row % rows) + rows) % rows);
+}
+
+void SpatialGrid::commit(const size_t count) {
+	mMoved = 0;
+	if (count != mCellOf.size()) {
+		// entities were added or removed and dense indices shifted, start over
+		std::fill(mHead.begin(), mHead.end(), End);
+		mCellOf.resize(count);
+		mNext.resize(count);
+		mPrevious.resize(count);
+		for (unsigned int i = 0; i < count; ++i) {
+			link(i, mNextCell[i]);
+		}
+		mMoved = count;
+		return;
+	}
+
+	for (unsigned int i = 0; i < count; ++i) {
+		const auto next = mNextCell[i];
+		if (next == mCellOf[i]) {
+			continue;
+		}
+		unlink(i);
+		link(i, next);
+		++mMoved;
+	}
+}
+
+void SpatialGrid::link(const unsigned int i, const unsigned int cell) {
+	mCellOf[i] = cell;
+	mPrevious[i] = End;
+	mNext[i] = mHead[cell];
+	if (mHead[cell] != End) {
+		mPrevious[mHead[cell]] = i;
+	}
+	mHead[cell] = i;
+}
+
+void SpatialGrid::unlink(const unsigned int i) {
+	if (mPrevious[i] != End) {
+		mNext[mPrevious[i]] = mNext[i];
+	}
+	else {
+		mHead[mCellOf[i]] = mNext[i];
+	}
+	if (mNext[i] != End) {
+		mPrevious[mNext[i]] = mPrevious[i];
+	}
+}
+
+float SpatialGrid::wrappedDistanceSqr(const float ax, const float ay, const float bx, const float by) const {
+	float dx = std::abs(ax - bx);
+	float dy = std::abs(ay - by);
+	dx = std::min(dx, mWidth - dx);
+	dy = std::min(dy, mHeight - dy);
+	return dx * dx + dy * dy;
+}
+
+void SpatialGrid::pairsBetween(const unsigned int a, const unsigned int b, const float distanceSqr, std::vector<Pair>& pairs) const {
+	// every pair within a's cell when b is the same cell, else every pair across the two
+	for (auto i = mHead[a]; i != End; i = mNext[i]) {
+		for (auto j = a == b ? mNext[i] : mHead[b]; j != End; j = mNext[j]) {
+			if (wrappedDistanceSqr(mX[i], mY[i], mX[j], mY[j]) < distanceSqr) {
+				pairs.emplace_back(std::min(i, j), std::max(i, j));
+			}
+		}
+	}
+}
+
+void SpatialGrid::broadphasePairs(const float distance, std::vector<Pair>& pairs) const {
+	pairs.clear();
+	if (mHead.empty()) {
+		return;
+	}
+
+	// the half-neighbourhood below only sees everything when the cell is at least as wide as the
+	// pair distance and the wrap does not make a neighbour show up twice
+	if (distance > std::min(mCellWidth, mCellHeight) || mColumns < 3 || mRows < 3) {
+		for (unsigned int i = 0; i < mCellOf.size(); ++i) {
+			queryRadius(mX[i], mY[i], distance, [&](const unsigned int j) {
+				if (i < j && wrappedDistanceSqr(mX[i], mY[i], mX[j], mY[j]) < distance * distance) {
+					pairs.emplace_back(i, j);
+				}
+			});
+		}
+		return;
+	}
+
+	const float distanceSqr = distance * distance;
+	const long long neighbours[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+	for (size_t row = 0; row < mRows; ++row) {
+		for (size_t column = 0; column < mColumns; ++column) {
+			const auto cell = static_cast<unsigned int>(row * mColumns + column);
+			if (mHead[cell] == End) {
+				continue;
+			}
+			pairsBetween(cell, cell, distanceSqr, pairs);
+			for (const auto& offset : neighbours) {
+				const auto neighbourColumn = wrapColumn(static_cast<long long>(column) + offset[0]);
+				const auto neighbourRow = wrapRow(static_cast<long long>(row) + offset[1]);
+				pairsBetween(cell, static_cast<unsigned int>(neighbourRow * mColumns + neighbourColumn), distanceSqr, pairs);
+			}
+		}
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Uniform grid over the toroidal world. Entities are referred to by their dense index into an
+// ECS column. update() only moves entities whose cell changed
+// since the previous call; a change in entity count triggers a full rebuild. Every cell is a list
+// linked through per-entity arrays, so once those have grown to the largest count the grid has
+// held, updating it allocates nothing however the entities crowd together.
+class SpatialGrid {
+public:
+	using Pair = std::pair<unsigned int, unsigned int>;
+
+	SpatialGrid() = default;
+	SpatialGrid(const float width, const float height, const float cellSize);
+
+	void reset(const float width, const float height, const float cellSize);
+	void clear();
+
+	// positionOf(i) returns something with .x and .y for i in [0, count)
+	template <typename PositionOf>
+	void update(const size_t count, PositionOf&& positionOf);
+	void update(const float* xs, const float* ys, const size_t count);
+
+	// visit(i) for every entity within radius of (x, y), distance measured across the wrap
+	template <typename Visit>
+	void queryRadius(const float x, const float y, const float radius, Visit&& visit) const;
+	// visit(i) for every entity inside [minX, maxX] x [minY, maxY]; the box may extend past the
+	// world edges and then wraps
+	template <typename Visit>
+	void queryAabb(const float minX, const float minY, const float maxX, const float maxY, Visit&& visit) const;
+	// every unordered pair closer than distance, each pair reported once with first < second
+	void broadphasePairs(const float distance, std::vector<Pair>& pairs) const;
+
+	size_t size() const { return mCellOf.size(); }
+	// entities that changed cell in the last update()
+	size_t moved() const { return mMoved; }
+	float wrappedDistanceSqr(const float ax, const float ay, const float bx, const float by) const;
+
+private:
+	unsigned int cellIndex(const float x, const float y) const;
+	size_t wrapColumn(const long long column) const;
+	size_t wrapRow(const long long row) const;
+	void commit(const size_t count);
+	void link(const unsigned int i, const unsigned int cell);
+	void unlink(const unsigned int i);
+	void pairsBetween(const unsigned int a, const unsigned int b, const float distanceSqr, std::vector<Pair>& pairs) const;
+
+	// terminates a cell's list
+	static constexpr unsigned int End = ~0u;
+
+	float mWidth{ 0.0f };
+	float mHeight{ 0.0f };
+	float mCellWidth{ 1.0f };
+	float mCellHeight{ 1.0f };
+	size_t mColumns{ 0 };
+	size_t mRows{ 0 };
+
+	// first entity of every cell, then the neighbours of every entity in its cell's list
+	std::vector<unsigned int> mHead;
+	std::vector<unsigned int> mNext;
+	std::vector<unsigned int> mPrevious;
+	std::vector<unsigned int> mCellOf;
+	std::vector<unsigned int> mNextCell;
+	std::vector<float> mX;
+	std::vector<float> mY;
+	size_t mMoved{ 0 };
+};
+
+template <typename PositionOf>
+inline void SpatialGrid::update(const size_t count, PositionOf&& positionOf) {
+	mNextCell.resize(count);
+	mX.resize(count);
+	mY.resize(count);
+	for (size_t i = 0; i < count; ++i) {
+		const auto position = positionOf(i);
+		mX[i] = position.x;
+		mY[i] = position.y;
+		mNextCell[i] = cellIndex(position.x, position.y);
+	}
+	commit(count);
+}
+
+template <typename Visit>
+inline void SpatialGrid::queryRadius(const float x, const float y, const float radius, Visit&& visit) const {
+	if (mHead.empty()) {
+		return;
+	}
+	const float radiusSqr = radius * radius;
+	queryAabb(x - radius, y - radius, x + radius, y + radius, [&](const unsigned int i) {
+		if (wrappedDistanceSqr(x, y, mX[i], mY[i]) <= radiusSqr) {
+			visit(i);
+		}
+	});
+}
+
+template <typename Visit>
+inline void SpatialGrid::queryAabb(const float minX, const float minY, const float maxX, const float maxY, Visit&& visit) const {
+	if (mHead.empty() || maxX < minX || maxY < minY) {
+		return;
+	}
+	const auto firstColumn = static_cast<long long>(std::floor(minX / mCellWidth));
+	const auto firstRow = static_cast<long long>(std::floor(minY / mCellHeight));
+	// never walk more cells than the grid has, or wrapped cells would be visited twice
+	const auto columns = std::min(static_cast<long long>(std::floor(maxX / mCellWidth)) - firstColumn + 1, static_cast<long long>(mColumns));
+	const auto rows = std::min(static_cast<long long>(std::floor(maxY / mCellHeight)) - firstRow + 1, static_cast<long long>(mRows));
+	const float spanX = maxX - minX;
+	const float spanY = maxY - minY;
+
+	for (long long r = 0; r < rows; ++r) {
+		const auto row = wrapRow(firstRow + r);
+		for (long long c = 0; c < columns; ++c) {
+			for (auto i = mHead[row * mColumns + wrapColumn(firstColumn + c)]; i != End; i = mNext[i]) {
+				// offset from the box corner, wrapped into [0, world size)
+				float dx = std::fmod(mX[i] - minX, mWidth);
+				float dy = std::fmod(mY[i] - minY, mHeight);
+				dx = dx < 0.0f ? dx + mWidth : dx;
+				dy = dy < 0.0f ? dy + mHeight : dy;
+				if (dx <= spanX && dy <= spanY) {
+					visit(i);
+				}
+			}
+		}
+	}
+}
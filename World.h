@@ -0,0 +1,35 @@
+#pragma once
+
+#include <Agent.h>
+#include <Collision.h>
+#include <ECS.h>
+#include <ParticleLifecycle.h>
+#include <Recording.h>
+#include <Simulation.h>
+#include <SpatialGrid.h>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct World {
+	size_t width{ 0 };
+	size_t height{ 0 };
+	uint64_t seed{ 0 };
+	// steps simulated since the world was created
+	size_t tick{ 0 };
+	ECS ecs;
+	// decides for every EntityType::Ship entity, the actions are written here each tick
+	std::unique_ptr<IPolicy> policy;
+	ShipActions shipActions;
+	// when set, logs the actions of every step
+	std::unique_ptr<GameJamAsteroids::ActionRecorder> recorder;
+	std::vector<sf::Vector3f> wells;
+	GameJamAsteroids::ParticleLifecycle particles;
+	GameJamAsteroids::ForceField field;
+	GameJamAsteroids::Integrator integrator{ GameJamAsteroids::Integrator::Simd };
+
+	SpatialGrid shipGrid;
+	SpatialGrid particleGrid;
+	std::vector<SpatialGrid::Pair> shipPairs;
+	GameJamAsteroids::CollisionStats collisions;
+};
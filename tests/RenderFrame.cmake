@@ -0,0 +1,11 @@
+# Renders a small fixed frame with the software rasterizer and compares it against the golden
+# image, pixel for pixel. Run with -DGAME=<GameJamAsteroids> -DGOLDEN=<ppm> -DOUTPUT=<ppm>; after
+# an intended change to what a frame looks like, copy OUTPUT over GOLDEN.
+execute_process(COMMAND ${GAME} --size 320x180 --seed 7 --ships 8 --render-frame ${OUTPUT} 30 3000 RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "rendering ${OUTPUT} failed")
+endif()
+execute_process(COMMAND ${GAME} --diff-images ${OUTPUT} ${GOLDEN} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${OUTPUT} differs from ${GOLDEN}")
+endif()